@@ -0,0 +1,138 @@
+#include "DungeonDebugDrawComponent.h"
+#include "HAL/IConsoleManager.h"
+#include "UObject/UObjectIterator.h"
+
+#if UE_ENABLE_DEBUG_DRAWING
+namespace DungeonDebugCVars
+{
+	static bool bDelaunay  = true;
+	static bool bMST       = true;
+	static bool bCenters   = true;
+	static bool bCorridors = true;
+
+	static void OnLayerToggled(IConsoleVariable*)
+	{
+		for (TObjectIterator<UDungeonDebugDrawComponent> It; It; ++It)
+			It->MarkRenderStateDirty();
+	}
+
+	static FAutoConsoleVariableRef CVarDelaunay(TEXT("dungeon.Debug.Delaunay"), bDelaunay,
+		TEXT("Draw the Delaunay triangulation of the main rooms."), FConsoleVariableDelegate::CreateStatic(&OnLayerToggled));
+	static FAutoConsoleVariableRef CVarMST(TEXT("dungeon.Debug.MST"), bMST,
+		TEXT("Draw the minimum spanning tree of the main rooms."), FConsoleVariableDelegate::CreateStatic(&OnLayerToggled));
+	static FAutoConsoleVariableRef CVarCenters(TEXT("dungeon.Debug.Centers"), bCenters,
+		TEXT("Draw the main room center markers."), FConsoleVariableDelegate::CreateStatic(&OnLayerToggled));
+	static FAutoConsoleVariableRef CVarCorridors(TEXT("dungeon.Debug.Corridors"), bCorridors,
+		TEXT("Draw the corridor segments."), FConsoleVariableDelegate::CreateStatic(&OnLayerToggled));
+}
+#endif
+
+UDungeonDebugDrawComponent::UDungeonDebugDrawComponent()
+{
+	SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	SetGenerateOverlapEvents(false);
+	bHiddenInGame = false;
+	bIsEditorOnly = false;
+}
+
+bool UDungeonDebugDrawComponent::IsLayerEnabled(EDungeonDebugLayer Layer)
+{
+#if UE_ENABLE_DEBUG_DRAWING
+	switch (Layer)
+	{
+	case EDungeonDebugLayer::Delaunay:  return DungeonDebugCVars::bDelaunay;
+	case EDungeonDebugLayer::MST:       return DungeonDebugCVars::bMST;
+	case EDungeonDebugLayer::Centers:   return DungeonDebugCVars::bCenters;
+	case EDungeonDebugLayer::Corridors: return DungeonDebugCVars::bCorridors;
+	default: break;
+	}
+#endif
+	return false;
+}
+
+void UDungeonDebugDrawComponent::ClearLayer(EDungeonDebugLayer Layer)
+{
+#if UE_ENABLE_DEBUG_DRAWING
+	Layers[static_cast<int32>(Layer)] = FLayer();
+	Invalidate();
+#endif
+}
+
+void UDungeonDebugDrawComponent::ClearAll()
+{
+#if UE_ENABLE_DEBUG_DRAWING
+	for (FLayer& L : Layers) L = FLayer();
+	Invalidate();
+#endif
+}
+
+void UDungeonDebugDrawComponent::AddLine(EDungeonDebugLayer Layer, const FVector& A, const FVector& B, const FColor& Color, float Thickness)
+{
+#if UE_ENABLE_DEBUG_DRAWING
+	FLayer& L = Layers[static_cast<int32>(Layer)];
+	L.Lines.Emplace(A, B, Color, Thickness);
+	L.Bounds += A;
+	L.Bounds += B;
+	Invalidate();
+#endif
+}
+
+void UDungeonDebugDrawComponent::AddBox(EDungeonDebugLayer Layer, const FVector& Center, const FVector& HalfExtent, const FColor& Color, float Thickness)
+{
+#if UE_ENABLE_DEBUG_DRAWING
+	// Boîte filaire en 12 lignes : elle rejoint le batch de lignes de sa couche
+	FVector C[8];
+	for (int32 i = 0; i < 8; ++i)
+	{
+		C[i] = Center + FVector((i & 1) ? HalfExtent.X : -HalfExtent.X,
+		                        (i & 2) ? HalfExtent.Y : -HalfExtent.Y,
+		                        (i & 4) ? HalfExtent.Z : -HalfExtent.Z);
+	}
+	static const int32 Edges[12][2] = {
+		{0,1},{2,3},{4,5},{6,7}, {0,2},{1,3},{4,6},{5,7}, {0,4},{1,5},{2,6},{3,7} };
+	for (const auto& E : Edges) AddLine(Layer, C[E[0]], C[E[1]], Color, Thickness);
+#endif
+}
+
+void UDungeonDebugDrawComponent::AddLabel(EDungeonDebugLayer Layer, const FVector& Location, const FString& Text, const FColor& Color)
+{
+#if UE_ENABLE_DEBUG_DRAWING
+	FLayer& L = Layers[static_cast<int32>(Layer)];
+	L.Labels.Emplace(Text, Location, Color);
+	L.Bounds += Location;
+	Invalidate();
+#endif
+}
+
+void UDungeonDebugDrawComponent::Invalidate()
+{
+	// Coalescé par le moteur : le proxy n'est recréé qu'une fois en fin de frame
+	UpdateBounds();
+	MarkRenderStateDirty();
+}
+
+FDebugRenderSceneProxy* UDungeonDebugDrawComponent::CreateDebugSceneProxy()
+{
+#if UE_ENABLE_DEBUG_DRAWING
+	FDebugRenderSceneProxy* Proxy = new FDebugRenderSceneProxy(this);
+	for (int32 i = 0; i < static_cast<int32>(EDungeonDebugLayer::Count); ++i)
+	{
+		if (!IsLayerEnabled(static_cast<EDungeonDebugLayer>(i))) continue;
+		Proxy->Lines.Append(Layers[i].Lines);
+		Proxy->Texts.Append(Layers[i].Labels);
+	}
+	return Proxy;
+#else
+	return nullptr;
+#endif
+}
+
+FBoxSphereBounds UDungeonDebugDrawComponent::CalcBounds(const FTransform& LocalToWorld) const
+{
+#if UE_ENABLE_DEBUG_DRAWING
+	FBox Box(ForceInit);
+	for (const FLayer& L : Layers) Box += L.Bounds;
+	if (Box.IsValid) return FBoxSphereBounds(Box);
+#endif
+	return FBoxSphereBounds(LocalToWorld.GetLocation(), FVector::ZeroVector, 0.f);
+}
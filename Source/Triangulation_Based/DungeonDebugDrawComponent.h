@@ -0,0 +1,52 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Debug/DebugDrawComponent.h"
+#include "DebugRenderSceneProxy.h"
+#include "DungeonDebugDrawComponent.generated.h"
+
+UENUM()
+enum class EDungeonDebugLayer : uint8
+{
+	Delaunay,
+	MST,
+	Centers,
+	Corridors,
+	Count UMETA(Hidden)
+};
+
+// Un seul proxy de debug pour tout le donjon : chaque couche est une liste de lignes batchée,
+// activable via les CVars dungeon.Debug.*. Vide et sans coût en Shipping.
+UCLASS(ClassGroup=Debug)
+class TRIANGULATION_BASED_API UDungeonDebugDrawComponent : public UDebugDrawComponent
+{
+	GENERATED_BODY()
+
+public:
+	UDungeonDebugDrawComponent();
+
+	void ClearLayer(EDungeonDebugLayer Layer);
+	void ClearAll();
+	void AddLine(EDungeonDebugLayer Layer, const FVector& A, const FVector& B, const FColor& Color, float Thickness);
+	void AddBox(EDungeonDebugLayer Layer, const FVector& Center, const FVector& HalfExtent, const FColor& Color, float Thickness);
+	void AddLabel(EDungeonDebugLayer Layer, const FVector& Location, const FString& Text, const FColor& Color);
+
+	static bool IsLayerEnabled(EDungeonDebugLayer Layer);
+
+protected:
+	virtual FDebugRenderSceneProxy* CreateDebugSceneProxy() override;
+	virtual FBoxSphereBounds CalcBounds(const FTransform& LocalToWorld) const override;
+
+private:
+	void Invalidate();
+
+#if UE_ENABLE_DEBUG_DRAWING
+	struct FLayer
+	{
+		TArray<FDebugRenderSceneProxy::FDebugLine> Lines;
+		TArray<FDebugRenderSceneProxy::FText3d>    Labels;
+		FBox Bounds = FBox(ForceInit);
+	};
+	FLayer Layers[static_cast<int32>(EDungeonDebugLayer::Count)];
+#endif
+};
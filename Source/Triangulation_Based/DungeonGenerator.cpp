@@ -1,13 +1,71 @@
 #include "DungeonGenerator.h"
-#include "DrawDebugHelpers.h"
-#include "Algo/Sort.h"
+#include "DungeonLayoutStream.h"
+#include "DungeonPoolSubsystem.h"
+#include "DungeonSchedulerSubsystem.h"
+#include "DungeonPropSet.h"
+#include "DungeonTetrahedralizer.h"
+#include "Triangulation_Based.h"
+#include "Engine/AssetManager.h"
+#include "Engine/GameInstance.h"
+#include "Engine/StreamableManager.h"
+#include "GameFramework/GameModeBase.h"
+#include "GameFramework/PlayerController.h"
+#include "Camera/PlayerCameraManager.h"
+#include "TimerManager.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
 #include "Components/InstancedStaticMeshComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "ProceduralMeshComponent.h"
+#include "Algo/Sort.h"
+#include "Async/Async.h"
+#include "Tasks/Task.h"
+#include "HAL/IConsoleManager.h"
 #include "Materials/MaterialInterface.h"
-#include <cfloat>
+#include "Net/UnrealNetwork.h"
+
+static TAutoConsoleVariable<int32> CVarDungeonMemoryBudgetMB(
+	TEXT("dungeon.MemoryBudgetMB"), 0,
+	TEXT("Memory budget of a dungeon in MB, overrides the generator's MemoryBudgetMB when > 0 (set it per platform in the device profiles)."));
+
+static TAutoConsoleVariable<int32> CVarDungeonPortalCulling(
+	TEXT("dungeon.PortalCulling"), 1,
+	TEXT("0: show every room, corridor and prop; 1: hide what the camera cannot see through the portal graph."));
+
+// Taille d'un objet : sa classe plus ce qu'il déclare posséder (GetResourceSizeEx)
+static SIZE_T ObjectBytes(UObject* Obj)
+{
+	return Obj ? Obj->GetClass()->GetStructureSize() + Obj->GetResourceSizeBytes(EResourceSizeMode::Exclusive) : 0;
+}
+
+// Segments présents d'un seul côté (différence symétrique, doublons compris)
+static void DiffCorridors(TArray<FCorridorSeg> Old, TArray<FCorridorSeg> New, TArray<FCorridorSeg>& Out)
+{
+	auto Less = [](const FCorridorSeg& L, const FCorridorSeg& R)
+	{
+		if (L.A.X != R.A.X) return L.A.X < R.A.X;
+		if (L.A.Y != R.A.Y) return L.A.Y < R.A.Y;
+		if (L.B.X != R.B.X) return L.B.X < R.B.X;
+		if (L.B.Y != R.B.Y) return L.B.Y < R.B.Y;
+		if (L.ZA != R.ZA) return L.ZA < R.ZA;
+		return L.ZB < R.ZB;
+	};
+	Algo::Sort(Old, Less);
+	Algo::Sort(New, Less);
+
+	int32 i = 0, j = 0;
+	while (i < Old.Num() || j < New.Num())
+	{
+		if (j == New.Num() || (i < Old.Num() && Less(Old[i], New[j]))) Out.Add(Old[i++]);
+		else if (i == Old.Num() || Less(New[j], Old[i])) Out.Add(New[j++]);
+		else { ++i; ++j; }
+	}
+}
 
 ADungeonGenerator::ADungeonGenerator()
 {
 	PrimaryActorTick.bCanEverTick = false;
+	bReplicates = true;
+	bAlwaysRelevant = true;
 
 	USceneComponent* Root = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
 	SetRootComponent(Root);
@@ -15,6 +73,19 @@ ADungeonGenerator::ADungeonGenerator()
 	CorridorISM = CreateDefaultSubobject<UInstancedStaticMeshComponent>(TEXT("CorridorISM"));
 	CorridorISM->SetupAttachment(RootComponent);
 	CorridorISM->SetMobility(EComponentMobility::Movable);
+
+	RoomISM = CreateDefaultSubobject<UInstancedStaticMeshComponent>(TEXT("RoomISM"));
+	RoomISM->SetupAttachment(RootComponent);
+	RoomISM->SetMobility(EComponentMobility::Movable);
+	RoomISM->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+
+	MainRoomISM = CreateDefaultSubobject<UInstancedStaticMeshComponent>(TEXT("MainRoomISM"));
+	MainRoomISM->SetupAttachment(RootComponent);
+	MainRoomISM->SetMobility(EComponentMobility::Movable);
+	MainRoomISM->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+
+	DebugDraw = CreateDefaultSubobject<UDungeonDebugDrawComponent>(TEXT("DebugDraw"));
+	DebugDraw->SetupAttachment(RootComponent);
 }
 
 void ADungeonGenerator::BeginPlay()
@@ -23,741 +94,1575 @@ void ADungeonGenerator::BeginPlay()
 
 	DungeonCenter = GetActorLocation();
 
-	CorridorSegments.Reset();
-	if (CorridorISM) CorridorISM->ClearInstances();
+	ClearDungeon();
 
-	for (ARoom* R : SpawnedRooms)
-		if (IsValid(R)) R->Destroy();
-	SpawnedRooms.Reset();
-	
-	GenerateDungeon();
-	
-	TArray<FRoomRef> Refs;
-	BuildRoomRefs(Refs);
-	for (int32 it = 0; it < MaxRelaxIterations; ++it)
+	// Classes, meshes et matériaux chargés pendant que le pipeline tourne ; la construction est différée jusqu'à leur arrivée
+	RequestAssets();
+
+	if (bPortalCulling && GetNetMode() != NM_DedicatedServer)
+		GetWorldTimerManager().SetTimer(PortalTimer, this, &ADungeonGenerator::UpdatePortalVisibility, PortalUpdateInterval, true);
+
+	if (!HasAuthority())
 	{
-		const int32 overlaps = RelaxOnce(Refs);
-		ApplyRefs(Refs);
-		if (overlaps == 0) break;
+		if (ReplicatedLayout.TotalBytes > 0) RebuildFromReplicatedLayout();
+		return;
 	}
 
-	if (bEnableCulling) StartDelayedCulling();
-	else SelectMainRooms();
+	// Joueurs arrivés après la publication : les gros layouts ne leur parviennent que par le flux
+	LoginHandle = FGameModeEvents::GameModePostLoginEvent.AddUObject(this, &ADungeonGenerator::OnPlayerLogin);
+
+	// Borne haute : le culling et le tri final ne font que retirer des salles
+	if (!ResolveMemoryMode(RoomsNbr)) return;
+
+	const FDungeonGenParams Params = MakeGenParams();
+
+	UDungeonPoolSubsystem* Pool = nullptr;
+	if (bUsePregeneratedPool && Seed == 0)
+		if (UGameInstance* GI = GetGameInstance()) Pool = GI->GetSubsystem<UDungeonPoolSubsystem>();
+
+	FDungeonLayout Layout;
+	if (Pool && Pool->Claim(Params, Layout))
+	{
+		UE_LOG(LogDungeon, Log, TEXT("Dungeon claimed from the pregenerated pool (seed %d)"), Layout.Seed);
+		LastStats = FDungeonGenStats();
+		LastStats.bCompact = bCompactRooms;
+	}
+	else if (UDungeonSchedulerSubsystem* Scheduler = bUseScheduler ? GetWorld()->GetSubsystem<UDungeonSchedulerSubsystem>() : nullptr)
+	{
+		// Génération en tâches partagées avec les autres générateurs du monde ; suite dans ApplyScheduledLayout
+		Scheduler->Submit(this, Params, PickSeed());
+		return;
+	}
+	else
+	{
+		FDungeonPipeline::Generate(Params, PickSeed(), Layout, &LastStats);
+		UE_LOG(LogDungeon, Log, TEXT("Dungeon generated (seed %d): %s"), Layout.Seed, *LastStats.ToString());
+	}
+
+	CommitLayout(MoveTemp(Layout), true);
+}
+
+void ADungeonGenerator::ApplyScheduledLayout(FDungeonLayout&& Layout, const FDungeonGenStats& Stats)
+{
+	LastStats = Stats;
+	UE_LOG(LogDungeon, Log, TEXT("Dungeon generated by the scheduler (seed %d): %s"), Layout.Seed, *LastStats.ToString());
+	CommitLayout(MoveTemp(Layout), true); // assets déjà chargés : le scheduler ne commit qu'une fois AreAssetsReady()
 }
 
 void ADungeonGenerator::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	if (GetWorld()) GetWorld()->GetTimerManager().ClearTimer(CullingTimerHandle);
+	GetWorldTimerManager().ClearTimer(PortalTimer);
+	FGameModeEvents::GameModePostLoginEvent.Remove(LoginHandle);
+	if (AssetHandle.IsValid()) AssetHandle->CancelHandle();
+	AssetHandle.Reset();
+	bAssetsRequested = false;
+	PendingLayout.Reset();
+	if (UDungeonSchedulerSubsystem* Scheduler = GetWorld() ? GetWorld()->GetSubsystem<UDungeonSchedulerSubsystem>() : nullptr)
+		Scheduler->Cancel(this);
+	ClearDungeon();
 
+	Super::EndPlay(EndPlayReason);
+}
+
+void ADungeonGenerator::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+	DOREPLIFETIME(ADungeonGenerator, ReplicatedLayout);
+}
+
+void ADungeonGenerator::ClearDungeon()
+{
+	ClearProxies();
 	if (CorridorISM) CorridorISM->ClearInstances();
+	if (RoomISM) RoomISM->ClearInstances();
+	if (MainRoomISM) MainRoomISM->ClearInstances();
+	for (UHierarchicalInstancedStaticMeshComponent* H : PropHISMs)
+		if (H) H->ClearInstances();
+	if (DebugDraw) DebugDraw->ClearAll();
 
 	for (ARoom* R : SpawnedRooms)
 		if (IsValid(R)) R->Destroy();
 
 	SpawnedRooms.Reset();
 	MainCenters.Reset();
-	Points2D.Reset();
+	GraphPoints.Reset();
 	CorridorSegments.Reset();
-
-	Super::EndPlay(EndPlayReason);
+	CorridorGrid.Reset();
+	CurrentLayout = FDungeonLayout();
+	bRuntimeEditPending = false;
+	bTrianglesStale = false;
+
+	bIncrementalReady = false;
+	RoomVertex.Reset();
+	VertexRooms.Reset();
+	CorridorSlots.Reset();
+	FreeCorridorSlots.Reset();
+	PropInstances.Reset();
+	FreePropSlots.Reset();
+
+	PortalGraph.Reset();
+	PortalShown.Reset();
+	RoomInstances.Reset();
+	CellPropStart.Reset();
+	CellProps.Reset();
 }
 
-FVector2D ADungeonGenerator::RandomPointInDisk(float Radius, FRandomStream& Rng) const
+int32 ADungeonGenerator::PickSeed() const
 {
-	const float Angle = Rng.FRandRange(0.f, 2.f * PI);
-	const float r = Radius * FMath::Sqrt(Rng.FRand());
-	return FVector2D(r * FMath::Cos(Angle), r * FMath::Sin(Angle));
+	if (Seed != 0) return Seed;
+	const uint64 Ticks = FDateTime::Now().GetTicks();
+	const int32 SeedG = static_cast<int32>(Ticks ^ (Ticks >> 32));
+	return (SeedG == 0) ? 1 : SeedG;
 }
 
-void ADungeonGenerator::GenerateDungeon()
+ARoom* ADungeonGenerator::SpawnRoom(const FVector2D& Center, const FVector2D& Size, int32 Floor)
 {
-	UWorld* W = GetWorld(); if (!W) return;
+	UWorld* W = GetWorld(); if (!W) return nullptr;
+
+	UClass* ClassToSpawn = GetRoomClass();
+	if (!ClassToSpawn) return nullptr; // déjà signalé par CheckAssets
+
+	FActorSpawnParameters Params;
+	Params.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	const FVector SpawnLoc(Center.X, Center.Y, DungeonCenter.Z + Floor * FloorHeight);
+	ARoom* Room = W->SpawnActor<ARoom>(ClassToSpawn, SpawnLoc, FRotator::ZeroRotator, Params);
+	if (!IsValid(Room)) return nullptr;
+
+	// Chaque machine construit ses propres salles à partir du layout répliqué
+	Room->SetReplicates(false);
+	Room->SizeXY = Size;
+	Room->Floor = Floor;
+	Room->Thickness = (FloorCount > 1) ? RoomHeight : 2000.f;
+	Room->SyncVisual();
+	SpawnedRooms.Add(Room);
+	return Room;
+}
 
-	const uint64 Ticks = FDateTime::Now().GetTicks();
-	int32 SeedG = static_cast<int32>(Ticks ^ (Ticks >> 32));
-	FRandomStream Rng(SeedG == 0 ? 1 : SeedG);
+void ADungeonGenerator::SpawnRoomInstances(const FDungeonLayout& Layout)
+{
+	if (!RoomISM || !MainRoomISM) return;
+
+	// Mode compact : une instance mise à l'échelle par salle, avec le mesh de la classe de salle, au lieu d'un acteur
+	UClass* Class = GetRoomClass();
+	if (!Class) return; // déjà signalé par CheckAssets
+	const ARoom* RoomCDO = Class->GetDefaultObject<ARoom>();
+	UStaticMesh* Mesh = IsValid(RoomCDO->VisualMesh) ? RoomCDO->VisualMesh->GetStaticMesh() : nullptr;
+	RoomISM->SetStaticMesh(Mesh);
+	MainRoomISM->SetStaticMesh(Mesh);
+	if (UMaterialInterface* Material = MainRoomMaterial.Get()) MainRoomISM->SetMaterial(0, Material);
+
+	TArray<FTransform> Rooms, Mains;
+	Rooms.Reserve(Layout.Rooms.Num());
+	for (const FDungeonRoomDesc& D : Layout.Rooms)
+		(D.bIsMain ? Mains : Rooms).Add(MakeRoomTransform(D));
+	RoomISM->AddInstances(Rooms, false, true);
+	MainRoomISM->AddInstances(Mains, false, true);
+}
 
-	UClass* ClassToSpawn = RoomClass ? RoomClass.Get() : ARoom::StaticClass();
+FTransform ADungeonGenerator::MakeRoomTransform(const FDungeonRoomDesc& D) const
+{
+	// Même placement et même échelle que SpawnRoom + ARoom::SyncVisual
+	const double Thickness = (FloorCount > 1) ? RoomHeight : 2000.0;
+	const FVector Loc(DungeonCenter.X + D.Center.X, DungeonCenter.Y + D.Center.Y, DungeonCenter.Z + D.Floor * FloorHeight);
+	const FVector Scale(FMath::Max(D.Size.X, 1.0) / 100.0, FMath::Max(D.Size.Y, 1.0) / 100.0, Thickness / 100.0);
+	return FTransform(FRotator::ZeroRotator, Loc, Scale);
+}
 
-	for (int32 i = 0; i < RoomsNbr; ++i)
+void ADungeonGenerator::BuildRoomRefs(TArray<FDungeonPipeline::FRoomRef>& Out) const
+{
+	Out.Reset();
+	if (bCompactRooms)
 	{
-		const FVector2D Off2D = RandomPointInDisk(SpawnRadius, Rng);
-		const FVector SpawnLoc = DungeonCenter + FVector(Off2D.X, Off2D.Y, 0.f);
-
-		const float SX = Rng.FRandRange(RoomSizeMin.X, RoomSizeMax.X);
-		const float SY = Rng.FRandRange(RoomSizeMin.Y, RoomSizeMax.Y);
-
-		FActorSpawnParameters Params;
-		Params.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
-
-		ARoom* Room = W->SpawnActor<ARoom>(ClassToSpawn, SpawnLoc, FRotator::ZeroRotator, Params);
-		if (IsValid(Room))
+		Out.Reserve(CurrentLayout.Rooms.Num());
+		for (const FDungeonRoomDesc& D : CurrentLayout.Rooms)
 		{
-			Room->SizeXY = FVector2D(SX, SY);
-			Room->Thickness = 2000.f;
-			Room->SyncVisual();
-			SpawnedRooms.Add(Room);
+			FDungeonPipeline::FRoomRef& R = Out.AddDefaulted_GetRef();
+			R.Center = D.Center;
+			R.Half   = D.Size * 0.5f;
+			R.Floor  = D.Floor;
 		}
+		return;
 	}
-}
 
-void ADungeonGenerator::BuildRoomRefs(TArray<FRoomRef>& Out) const
-{
-	Out.Reset();
 	Out.Reserve(SpawnedRooms.Num());
+	const FVector2D Origin(DungeonCenter.X, DungeonCenter.Y);
 	for (ARoom* A : SpawnedRooms)
 	{
 		if (!IsValid(A)) continue;
 		const FVector L = A->GetActorLocation();
-		FRoomRef R;
-		R.Actor  = A;
-		R.Center = FVector2D(L.X, L.Y);
+		FDungeonPipeline::FRoomRef R;
+		R.Center = FVector2D(L.X, L.Y) - Origin;
 		R.Half   = A->SizeXY * 0.5f;
+		R.Floor  = A->Floor;
 		Out.Add(R);
 	}
 }
 
-bool ADungeonGenerator::Overlap(const FRoomRef& A, const FRoomRef& B, float Padding)
+void ADungeonGenerator::CollectAndStoreMainCenters()
 {
-	const FVector2D d = (A.Center - B.Center).GetAbs();
-	return (d.X < (A.Half.X + B.Half.X - Padding)) && (d.Y < (A.Half.Y + B.Half.Y - Padding));
-}
+	MainCenters.Reset();
+	GraphPoints.Reset();
 
-FVector2D ADungeonGenerator::MTV(const FRoomRef& A, const FRoomRef& B)
-{
-	const FVector2D d = B.Center - A.Center;
-	const float ox = (A.Half.X + B.Half.X) - FMath::Abs(d.X);
-	const float oy = (A.Half.Y + B.Half.Y) - FMath::Abs(d.Y);
-	if (ox < oy)
+	if (bCompactRooms)
 	{
-		const float sx = (d.X >= 0.f) ? 1.f : -1.f;
-		return FVector2D(ox * sx, 0.f);
+		// Pas d'acteurs : mêmes centres que GetActorBounds sur le cube mis à l'échelle
+		const double HalfThickness = 0.5 * ((FloorCount > 1) ? RoomHeight : 2000.0);
+		for (const FDungeonRoomDesc& D : CurrentLayout.Rooms)
+		{
+			if (!D.bIsMain) continue;
+			const FVector Origin(DungeonCenter.X + D.Center.X, DungeonCenter.Y + D.Center.Y, DungeonCenter.Z + D.Floor * FloorHeight);
+			MainCenters.Add(Origin + FVector(0, 0, HalfThickness + MainCenterZOffset));
+			GraphPoints.Add(Origin);
+		}
+		return;
 	}
-	else
+
+	for (ARoom* R : SpawnedRooms)
 	{
-		const float sy = (d.Y >= 0.f) ? 1.f : -1.f;
-		return FVector2D(0.f, oy * sy);
+		if (!IsValid(R) || !R->bIsMain) continue;
+
+		FVector Origin, Extent;
+		R->GetActorBounds(false, Origin, Extent);
+
+		FVector C = Origin;
+		C.Z = Origin.Z + Extent.Z + MainCenterZOffset;
+
+		MainCenters.Add(C);
+		GraphPoints.Add(Origin);
 	}
 }
 
-int32 ADungeonGenerator::RelaxOnce(TArray<FRoomRef>& Refs)
+void ADungeonGenerator::DrawMainCenters() const
 {
-	int32 overlaps = 0;
-	for (int32 i = 0; i < Refs.Num(); ++i)
+#if UE_ENABLE_DEBUG_DRAWING
+	if (!DebugDraw) return;
+	DebugDraw->ClearLayer(EDungeonDebugLayer::Centers);
+	if (!bDrawMainCenters) return;
+
+	for (int32 i = 0; i < MainCenters.Num(); ++i)
 	{
-		if (!Refs[i].IsValid()) continue;
-		for (int32 j = i + 1; j < Refs.Num(); ++j)
-		{
-			if (!Refs[j].IsValid()) continue;
+		const FVector P = MainCenters[i];
 
-			if (Overlap(Refs[i], Refs[j], ContactPadding))
-			{
-				overlaps++;
-				FVector2D mtv = MTV(Refs[i], Refs[j]);
-				mtv.X = FMath::Clamp(mtv.X, -NudgeClamp, NudgeClamp);
-				mtv.Y = FMath::Clamp(mtv.Y, -NudgeClamp, NudgeClamp);
-				Refs[i].Center -= mtv * 0.5f;
-				Refs[j].Center += mtv * 0.5f;
-			}
+		DebugDraw->AddBox(EDungeonDebugLayer::Centers, P, CenterMarkerHalfExtent, FColor::Cyan, 8.f);
+		DebugDraw->AddLine(EDungeonDebugLayer::Centers, P - FVector(0,0,CenterPillarHeight), P, FColor::Cyan, 8.f);
+
+		if (bDrawCenterLabel)
+		{
+			DebugDraw->AddLabel(EDungeonDebugLayer::Centers, P + FVector(0,0,CenterMarkerHalfExtent.Z + 20.f),
+				FString::Printf(TEXT("#%d"), i), FColor::Cyan);
 		}
 	}
-	return overlaps;
+#endif
 }
 
-void ADungeonGenerator::ApplyRefs(const TArray<FRoomRef>& Refs)
+void ADungeonGenerator::DrawDebugViz()
 {
-	for (const FRoomRef& R : Refs)
+#if UE_ENABLE_DEBUG_DRAWING
+	if (!DebugDraw) return;
+	DebugDraw->ClearLayer(EDungeonDebugLayer::Delaunay);
+	DebugDraw->ClearLayer(EDungeonDebugLayer::MST);
+	if (!bDrawDelaunay) return;
+
+	const FVector Z_Del(0, 0, DelaunayZDebugOffset);
+	const FVector Z_MST(0, 0, MSTZDebugOffset);
+
+	for (const FDGTriangle& T : CurrentLayout.DelaunayTriangles)
+	{
+		const FVector A = GraphPoints[T.I] + Z_Del;
+		const FVector B = GraphPoints[T.J] + Z_Del;
+		const FVector C = GraphPoints[T.K] + Z_Del;
+		DebugDraw->AddLine(EDungeonDebugLayer::Delaunay, A, B, FColor::Blue, 6.f);
+		DebugDraw->AddLine(EDungeonDebugLayer::Delaunay, B, C, FColor::Blue, 6.f);
+		DebugDraw->AddLine(EDungeonDebugLayer::Delaunay, C, A, FColor::Blue, 6.f);
+	}
+
+	// Multi-étages : arêtes uniques des tétraèdres, chaque arête est partagée par plusieurs d'entre eux
+	TSet<FDGEdge> TetEdges;
+	for (const FDGTetra& T : CurrentLayout.DelaunayTetrahedra)
+	{
+		const int32 V[4] = { T.I, T.J, T.K, T.L };
+		for (int32 a = 0; a < 4; ++a)
+			for (int32 b = a + 1; b < 4; ++b) TetEdges.Add(FDGEdge(V[a], V[b]));
+	}
+	for (const FDGEdge& E : TetEdges)
+	{
+		DebugDraw->AddLine(EDungeonDebugLayer::Delaunay, GraphPoints[E.A] + Z_Del, GraphPoints[E.B] + Z_Del, FColor::Blue, 6.f);
+	}
+
+	for (const FDGEdge& E : CurrentLayout.MSTEdges)
 	{
-		if (!R.IsValid()) continue;
-		R.Actor->SetActorLocation(FVector(R.Center.X, R.Center.Y, DungeonCenter.Z));
+		const FVector A = GraphPoints[E.A] + Z_MST;
+		const FVector B = GraphPoints[E.B] + Z_MST;
+		DebugDraw->AddLine(EDungeonDebugLayer::MST, A, B, FColor::Green, 12.f);
 	}
+#endif
 }
 
-void ADungeonGenerator::StartDelayedCulling()
+void ADungeonGenerator::DrawCorridorsDebug() const
 {
-	if (!GetWorld()) return;
-	GetWorld()->GetTimerManager().SetTimer(
-		CullingTimerHandle, this, &ADungeonGenerator::DoFinalCulling, CullingDelaySeconds, false);
+#if UE_ENABLE_DEBUG_DRAWING
+	if (!DebugDraw) return;
+	DebugDraw->ClearLayer(EDungeonDebugLayer::Corridors);
+
+	const float Z = DungeonCenter.Z + CorridorZOffset;
+	const FColor Color(0, 160, 255);
+
+	for (const FCorridorSeg& S : CorridorSegments)
+	{
+		if (S.A == S.B && S.ZA == S.ZB) continue; // emplacement libéré par une mise à jour incrémentale
+		const FVector P0(S.A.X, S.A.Y, Z + S.ZA);
+		const FVector P1(S.B.X, S.B.Y, Z + S.ZB);
+		DebugDraw->AddLine(EDungeonDebugLayer::Corridors, P0, P1, Color, CorridorThickness);
+
+		DebugDraw->AddBox(EDungeonDebugLayer::Corridors, P0, FVector(30,30,30), Color, 6.f);
+		DebugDraw->AddBox(EDungeonDebugLayer::Corridors, P1, FVector(30,30,30), Color, 6.f);
+	}
+#endif
 }
 
-void ADungeonGenerator::DoFinalCulling()
+void ADungeonGenerator::SpawnCorridorMeshes()
 {
-	TArray<FRoomRef> Refs;
-	BuildRoomRefs(Refs);
+	if (!CorridorISM) return;
+
+	CorridorISM->ClearInstances();
 
-	for (int32 it = 0; it < 10; ++it)
+	if (UStaticMesh* Mesh = CorridorMesh.Get())
 	{
-		const int32 overlaps = RelaxOnce(Refs);
-		if (overlaps == 0) break;
+		CorridorISM->SetStaticMesh(Mesh);
+	}
+	UMaterialInterface* Material = CorridorMaterial.Get();
+	if (Material && CorridorISM->GetMaterial(0) != Material)
+	{
+		CorridorISM->SetMaterial(0, Material);
+	}
+	
+	// Une instance par segment, même dégénéré (échelle nulle) : l'indice d'instance est celui du segment
+	for (const FCorridorSeg& S : CorridorSegments)
+	{
+		FTransform Xform(FQuat::Identity, FVector::ZeroVector, FVector::ZeroVector);
+		MakeCorridorTransform(S, Xform);
+		CorridorISM->AddInstance(Xform, true);
 	}
-	CullResidualOverlaps(Refs);
-	ApplyRefs(Refs);
-
-	SelectMainRooms();
 }
 
-void ADungeonGenerator::CullResidualOverlaps(TArray<FRoomRef>& Refs)
+bool ADungeonGenerator::MakeCorridorTransform(const FCorridorSeg& S, FTransform& Out) const
 {
-	if (!bEnableCulling || MaxCulls <= 0) return;
+	const float Base = 100.f;
 
-	int32 culls = 0;
-	bool changed = true;
+	const FVector2D AB = S.B - S.A;
+	const float Len2D = AB.Size();
+	const float DZ = S.ZB - S.ZA;
+	const float Len = FMath::Sqrt(Len2D * Len2D + DZ * DZ);
+	if (Len <= KINDA_SMALL_NUMBER) return false;
+
+	const FVector Mid(
+		(S.A.X + S.B.X) * 0.5f,
+		(S.A.Y + S.B.Y) * 0.5f,
+		DungeonCenter.Z + CorridorZOffset + (S.ZA + S.ZB) * 0.5f + (CorridorHeight * 0.5f));
+
+	const float YawDeg = FMath::RadiansToDegrees(FMath::Atan2(AB.Y, AB.X));
+	const float PitchDeg = FMath::RadiansToDegrees(FMath::Atan2(DZ, Len2D)); // rampe entre deux étages
+
+	Out = FTransform(
+		FRotator(PitchDeg, YawDeg, 0.f),
+		Mid,
+		FVector(Len / Base, CorridorWidth / Base, CorridorHeight / Base)
+	);
+	return true;
+}
 
-	while (changed && culls < MaxCulls)
+void ADungeonGenerator::SpawnProps()
+{
+	for (UHierarchicalInstancedStaticMeshComponent* H : PropHISMs)
+		if (H) H->ClearInstances();
+	PropInstances.Reset();
+	FreePropSlots.Reset();
+	if (!PropSet || CurrentLayout.Props.Num() == 0) return;
+
+	LLM_SCOPE_BYTAG(Dungeon_Rooms);
+
+	FDungeonPropRules Rules;
+	PropSet->ToRules(Rules);
+	TArray<int32> ComponentOfRule;
+	ResolvePropComponents(Rules, ComponentOfRule);
+
+	// Toutes les instances d'abord, puis un seul AddInstances par composant : un seul rebuild de l'arbre du HISM
+	TArray<TArray<FTransform>> Transforms;
+	Transforms.SetNum(PropHISMs.Num());
+	PropInstances.Reserve(CurrentLayout.Props.Num());
+	for (const FDungeonProp& P : CurrentLayout.Props)
 	{
-		changed = false;
-		for (int32 i = 0; i < Refs.Num(); ++i)
+		if (!ComponentOfRule.IsValidIndex(P.Rule) || ComponentOfRule[P.Rule] == INDEX_NONE)
 		{
-			if (!Refs[i].IsValid()) continue;
+			PropInstances.Emplace(INDEX_NONE, INDEX_NONE);
+			continue;
+		}
+		const int32 c = ComponentOfRule[P.Rule];
+		PropInstances.Emplace(c, Transforms[c].Num());
+		Transforms[c].Add(MakePropTransform(P));
+	}
+	for (int32 c = 0; c < PropHISMs.Num(); ++c)
+	{
+		if (PropHISMs[c] && Transforms[c].Num() > 0) PropHISMs[c]->AddInstances(Transforms[c], false, true);
+	}
+}
 
-			for (int32 j = i + 1; j < Refs.Num(); ++j)
-			{
-				if (!Refs[j].IsValid()) continue;
-
-				if (Overlap(Refs[i], Refs[j], ContactPadding))
-				{
-					const FVector2D mtv = MTV(Refs[i], Refs[j]);
-					const float pen = FMath::Max(FMath::Abs(mtv.X), FMath::Abs(mtv.Y));
-
-					if (pen > CullPenetrationThreshold)
-					{
-						const int32 kill = (Refs[i].Area() <= Refs[j].Area()) ? i : j;
-						if (IsValid(Refs[kill].Actor)) Refs[kill].Actor->Destroy();
-						Refs[kill].Actor = nullptr;
-						Refs.RemoveAll([](const FRoomRef& R){ return !R.IsValid(); });
-						++culls; changed = true; break;
-					}
-				}
-			}
-			if (changed) break;
+void ADungeonGenerator::ResolvePropComponents(const FDungeonPropRules& Rules, TArray<int32>& ComponentOfRule)
+{
+	// Un HISM par mesh distinct, créé à la première utilisation puis réutilisé
+	ComponentOfRule.Init(INDEX_NONE, Rules.Rules.Num());
+	for (int32 r = 0; r < Rules.Rules.Num(); ++r)
+	{
+		const TSoftObjectPtr<UStaticMesh>& MeshRef = PropSet->Props[Rules.Rules[r].Entry].Mesh;
+		UStaticMesh* Mesh = MeshRef.Get();
+		if (!Mesh)
+		{
+			// Les constructions attendent les assets : un mesh absent ici n'a pas pu être chargé
+			UE_LOG(LogDungeon, Error, TEXT("Prop rule %d has no loaded mesh (%s), its props are not spawned"), r, *MeshRef.ToString());
+			continue;
+		}
+		int32 c = PropHISMs.IndexOfByPredicate([Mesh](const UHierarchicalInstancedStaticMeshComponent* H) { return H && H->GetStaticMesh() == Mesh; });
+		if (c == INDEX_NONE)
+		{
+			UHierarchicalInstancedStaticMeshComponent* H = NewObject<UHierarchicalInstancedStaticMeshComponent>(this);
+			H->SetupAttachment(RootComponent);
+			H->SetMobility(EComponentMobility::Movable);
+			H->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+			H->SetStaticMesh(Mesh);
+			H->RegisterComponent();
+			AddInstanceComponent(H);
+			c = PropHISMs.Add(H);
 		}
+		ComponentOfRule[r] = c;
 	}
 }
 
-bool ADungeonGenerator::TooCloseAABB(const ARoom* A, const ARoom* B, float ExtraGap)
+FTransform ADungeonGenerator::MakePropTransform(const FDungeonProp& P) const
 {
-	if (!IsValid(A) || !IsValid(B)) return false;
+	// Posés au niveau du sol des couloirs de leur étage
+	const FVector Loc(DungeonCenter.X + P.Position.X, DungeonCenter.Y + P.Position.Y, DungeonCenter.Z + CorridorZOffset + P.Floor * FloorHeight);
+	return FTransform(FRotator(0.f, P.Yaw, 0.f), Loc, FVector(P.Scale));
+}
 
-	const FVector2D CA(A->GetActorLocation().X, A->GetActorLocation().Y);
-	const FVector2D CB(B->GetActorLocation().X, B->GetActorLocation().Y);
+void ADungeonGenerator::SelectMainRooms()
+{
+	TArray<FDungeonPipeline::FRoomRef> Refs;
+	BuildRoomRefs(Refs);
 
-	const FVector2D HA = A->SizeXY * 0.5f + FVector2D(ExtraGap, ExtraGap);
-	const FVector2D HB = B->SizeXY * 0.5f + FVector2D(ExtraGap, ExtraGap);
+	FDungeonLayout Layout;
+	Layout.Seed = ActiveSeed;
+	FDungeonPipeline::Finish(MakeGenParams(), Refs, Layout, &LastStats);
 
-	const FVector2D d = (CA - CB).GetAbs();
-	return (d.X < (HA.X + HB.X)) && (d.Y < (HA.Y + HB.Y));
+	CommitLayout(MoveTemp(Layout), HasAuthority());
 }
 
-void ADungeonGenerator::RelaxMainRoomsPositions(const TArray<ARoom*>& Mains)
+int32 ADungeonGenerator::InsertMainRoom(FVector2D WorldCenter, FVector2D Size, int32 RoomFloor)
 {
-	for (int32 it = 0; it < 10; ++it)
+	if (!HasAuthority())
 	{
-		bool moved = false;
-		for (int32 i = 0; i < Mains.Num(); ++i)
-		{
-			for (int32 j = i + 1; j < Mains.Num(); ++j)
-			{
-				if (!TooCloseAABB(Mains[i], Mains[j], MinMainGap)) continue;
+		UE_LOG(LogDungeon, Warning, TEXT("InsertMainRoom is server-only, clients follow the replicated layout"));
+		return INDEX_NONE;
+	}
+	if (PendingLayout.IsSet())
+	{
+		UE_LOG(LogDungeon, Warning, TEXT("InsertMainRoom ignored: the dungeon is still waiting for its assets"));
+		return INDEX_NONE;
+	}
 
-				FVector2D CA(Mains[i]->GetActorLocation().X, Mains[i]->GetActorLocation().Y);
-				FVector2D CB(Mains[j]->GetActorLocation().X, Mains[j]->GetActorLocation().Y);
-				FVector2D push = (CB - CA).GetSafeNormal() * 40.f;
+	const double StartTime = FPlatformTime::Seconds();
+	const FDungeonGenParams P = MakeGenParams();
+	ShowAllCells(); // les indices d'instances vont changer
 
-				Mains[i]->AddActorWorldOffset(FVector(-push.X, -push.Y, 0));
-				Mains[j]->AddActorWorldOffset(FVector( push.X,  push.Y, 0));
-				moved = true;
-			}
+	// Valeurs quantifiées comme celles du pipeline : le client reconstruit les mêmes couloirs
+	FDungeonRoomDesc D;
+	D.Center  = FDungeonLayout::Quantize(WorldCenter - FVector2D(DungeonCenter.X, DungeonCenter.Y));
+	D.Size    = FDungeonLayout::Quantize(FVector2D(FMath::Max(Size.X, 1.0), FMath::Max(Size.Y, 1.0)));
+	D.Floor   = FMath::Clamp(RoomFloor, 0, P.FloorCount - 1);
+	D.bIsMain = true;
+
+	FDungeonIncrementalGraph::FDelta Delta;
+	TArray<FCorridorSeg> Changed;
+	const int32 Vertex = EnsureIncrementalGraph(P, Changed) ? IncrementalGraph.Insert(D.Center, Delta) : INDEX_NONE;
+
+	// Ajoutée en fin de layout : dernière main room et plus grand id, les deux ordres restent alignés
+	const int32 RoomIndex = CurrentLayout.Rooms.Add(D);
+	{
+		LLM_SCOPE_BYTAG(Dungeon_Rooms);
+		if (bCompactRooms)
+		{
+			if (MainRoomISM) MainRoomISM->AddInstance(MakeRoomTransform(D), true);
 		}
-		if (!moved) break;
+		else if (ARoom* Room = SpawnRoom(FVector2D(DungeonCenter.X, DungeonCenter.Y) + D.Center, D.Size, D.Floor))
+		{
+			Room->bIsMain = true;
+			UMaterialInterface* Material = MainRoomMaterial.Get();
+			if (Material && IsValid(Room->VisualMesh)) Room->VisualMesh->SetMaterial(0, Material);
+		}
+	}
+
+	if (Vertex != INDEX_NONE)
+	{
+		RoomVertex.Add(Vertex);
+		if (VertexRooms.Num() <= Vertex) VertexRooms.SetNum(Vertex + 1);
+		VertexRooms[Vertex] = D;
+		ApplyGraphDelta(P, Delta, Changed);
+		RepopulateRoomsNear(P, Changed, RoomIndex);
+		FInstanceBatch Batch;
+		SpawnRoomProps(P, D, Batch);
+		ApplyInstanceBatch(Batch);
+	}
+	else
+	{
+		RebuildGraphFromLayout(P); // repeuple toutes les salles, la nouvelle comprise
 	}
+	FinishRuntimeEdit();
+
+	UE_LOG(LogDungeon, Log, TEXT("Main room %d inserted in %.2f ms (%s, %d triangles, MST -%d/+%d)"),
+		RoomIndex, (FPlatformTime::Seconds() - StartTime) * 1000.0, Vertex != INDEX_NONE ? TEXT("incremental") : TEXT("full rebuild"),
+		Delta.TouchedTriangles, Delta.RemovedEdges.Num(), Delta.AddedEdges.Num());
+	return RoomIndex;
 }
 
-void ADungeonGenerator::CollectAndStoreMainCenters()
+bool ADungeonGenerator::RemoveMainRoom(int32 RoomIndex)
 {
-	MainCenters.Reset();
-	Points2D.Reset();
-
-	for (ARoom* R : SpawnedRooms)
+	if (!HasAuthority() || !CurrentLayout.Rooms.IsValidIndex(RoomIndex) || !CurrentLayout.Rooms[RoomIndex].bIsMain) return false;
+	if (PendingLayout.IsSet())
 	{
-		if (!IsValid(R) || !R->bIsMain) continue;
+		UE_LOG(LogDungeon, Warning, TEXT("RemoveMainRoom ignored: the dungeon is still waiting for its assets"));
+		return false;
+	}
 
-		FVector Origin, Extent;
-		R->GetActorBounds(false, Origin, Extent);
+	const double StartTime = FPlatformTime::Seconds();
+	const FDungeonGenParams P = MakeGenParams();
+	const FDungeonRoomDesc D = CurrentLayout.Rooms[RoomIndex];
+	ShowAllCells();
 
-		FVector C = Origin;
-		C.Z = Origin.Z + Extent.Z + MainCenterZOffset;
+	FDungeonIncrementalGraph::FDelta Delta;
+	TArray<FCorridorSeg> Changed;
+	const bool bIncremental = EnsureIncrementalGraph(P, Changed) && IncrementalGraph.Remove(RoomVertex[RoomIndex], Delta);
 
-		MainCenters.Add(C);
-		Points2D.Add(FVector2D(Origin.X, Origin.Y));
+	HideRoomProps(MakeArrayView(&D, 1));
+	if (bCompactRooms)
+	{
+		// Les instances de MainRoomISM suivent l'ordre des main rooms
+		int32 MainIndex = 0;
+		for (int32 i = 0; i < RoomIndex; ++i) MainIndex += CurrentLayout.Rooms[i].bIsMain ? 1 : 0;
+		if (MainRoomISM) MainRoomISM->RemoveInstance(MainIndex);
+	}
+	else if (SpawnedRooms.IsValidIndex(RoomIndex))
+	{
+		if (IsValid(SpawnedRooms[RoomIndex])) SpawnedRooms[RoomIndex]->Destroy();
+		SpawnedRooms.RemoveAt(RoomIndex);
+	}
+	CurrentLayout.Rooms.RemoveAt(RoomIndex);
+	if (bIncrementalReady) RoomVertex.RemoveAt(RoomIndex);
+
+	if (bIncremental)
+	{
+		ApplyGraphDelta(P, Delta, Changed);
+		RepopulateRoomsNear(P, Changed, INDEX_NONE);
+	}
+	else
+	{
+		RebuildGraphFromLayout(P);
 	}
+	FinishRuntimeEdit();
+
+	UE_LOG(LogDungeon, Log, TEXT("Main room %d removed in %.2f ms (%s, %d triangles, MST -%d/+%d)"),
+		RoomIndex, (FPlatformTime::Seconds() - StartTime) * 1000.0, bIncremental ? TEXT("incremental") : TEXT("full rebuild"),
+		Delta.TouchedTriangles, Delta.RemovedEdges.Num(), Delta.AddedEdges.Num());
+	return true;
 }
 
-void ADungeonGenerator::DrawMainCenters() const
+bool ADungeonGenerator::EnsureIncrementalGraph(const FDungeonGenParams& P, TArray<FCorridorSeg>& Changed)
 {
-	if (!bDrawMainCenters) return;
-	UWorld* W = GetWorld(); if (!W) return;
+	if (bIncrementalReady) return true;
+	if (P.FloorCount > 1) return false; // graphe 3D : pas de version incrémentale, repli sur RebuildGraphFromLayout
+
+	// Premier changement : graphe, MST et couloirs reconstruits une fois, puis tenus à jour localement
+	TArray<FVector2D> Points;
+	TArray<int32> MainRooms;
+	FDungeonPipeline::MainRoomCenters(CurrentLayout, Points, &MainRooms);
+	TArray<int32> Ids;
+	IncrementalGraph.Reset(Points, P.SpawnRadius, Ids);
+
+	RoomVertex.Init(INDEX_NONE, CurrentLayout.Rooms.Num());
+	VertexRooms.Reset();
+	for (int32 i = 0; i < Ids.Num(); ++i)
+	{
+		if (Ids[i] == INDEX_NONE) continue; // centre en double
+		RoomVertex[MainRooms[i]] = Ids[i];
+		if (VertexRooms.Num() <= Ids[i]) VertexRooms.SetNum(Ids[i] + 1);
+		VertexRooms[Ids[i]] = CurrentLayout.Rooms[MainRooms[i]];
+	}
 
-	for (int32 i = 0; i < MainCenters.Num(); ++i)
+	// Prim et le graphe incrémental ne départagent pas de la même façon les arêtes de même longueur
+	// (centres quantifiés) : le MST repris peut différer du MST publié, loin de l'édition
+	TArray<FDGEdge> Edges;
+	IncrementalGraph.GetMSTEdges(Edges);
+	TArray<int32> MainOfVertex;
+	BuildMainOfVertex(MainOfVertex);
+	TSet<FDGEdge> Committed(CurrentLayout.MSTEdges);
+	bool bSameMST = Committed.Num() == Edges.Num();
+	for (int32 i = 0; i < Edges.Num() && bSameMST; ++i)
+		bSameMST = Committed.Contains(FDGEdge(MainOfVertex[Edges[i].A], MainOfVertex[Edges[i].B]));
+
+	// Une instance de CorridorISM par segment, réservée à son arête du MST
+	TArray<FCorridorSeg> Before = MoveTemp(CurrentLayout.Corridors);
+	CorridorSegments.Reset();
+	CurrentLayout.Corridors.Reset();
+	CorridorGrid.Reset();
+	CorridorSlots.Reset();
+	FreeCorridorSlots.Reset();
+	SpawnCorridorMeshes();
+	for (const FDGEdge& E : Edges) EmitCorridor(P, E);
+
+	// Couloirs recâblés : leurs salles sont repeuplées comme pour une édition
+	const int32 Num = Changed.Num();
+	DiffCorridors(MoveTemp(Before), CurrentLayout.Corridors, Changed);
+	if (!bSameMST || Changed.Num() > Num)
 	{
-		const FVector P = MainCenters[i];
+		UE_LOG(LogDungeon, Log, TEXT("Incremental MST %s the committed one: %d corridor segments changed"),
+			bSameMST ? TEXT("matches") : TEXT("differs from"), Changed.Num() - Num);
+	}
 
-		DrawDebugSolidBox(W, P, CenterMarkerHalfExtent, FColor::Cyan, true, DebugDuration);
-		DrawDebugLine(W, P - FVector(0,0,CenterPillarHeight), P, FColor::Cyan, true, DebugDuration, 0, 8.f);
+	bIncrementalReady = true;
+	return true;
+}
 
-		if (bDrawCenterLabel)
+void ADungeonGenerator::RebuildGraphFromLayout(const FDungeonGenParams& P)
+{
+	// Repli (multi-étages, point hors du domaine, centre en double) : graphe et couloirs recalculés en entier
+	TArray<FDGTriangle> LocalTriangles;
+	TArray<FDGTetra> LocalTetrahedra;
+	TSet<FDGEdge> GraphEdges;
+	CurrentLayout.DelaunayTriangles.Reset();
+	CurrentLayout.DelaunayTetrahedra.Reset();
+	if (P.FloorCount > 1)
+	{
+		TArray<FVector> Points;
+		FDungeonPipeline::MainRoomCenters3D(CurrentLayout, P.FloorHeight, Points);
+		FDungeonTetrahedralizer::Build(Points, P.bCompactLayout ? LocalTetrahedra : CurrentLayout.DelaunayTetrahedra, GraphEdges);
+		FDungeonPipeline::BuildMST_Kruskal(Points, GraphEdges, CurrentLayout.MSTEdges);
+	}
+	else
+	{
+		TArray<FVector2D> Points;
+		FDungeonPipeline::MainRoomCenters(CurrentLayout, Points);
+		TArray<FDGTriangle>& Triangles = P.bCompactLayout ? LocalTriangles : CurrentLayout.DelaunayTriangles;
+		FDungeonPipeline::BuildDelaunay(Points, Triangles);
+		FDungeonPipeline::EdgesFromTriangles(Triangles, GraphEdges);
+		FDungeonPipeline::BuildMST_Prim(Points, GraphEdges, CurrentLayout.MSTEdges);
+	}
+
+	CurrentLayout.Corridors.Reset();
+	if (P.bBuildCorridors) FDungeonPipeline::BuildCorridors(P, CurrentLayout);
+	CorridorGrid.Build(CurrentLayout.Corridors);
+
+	const FVector2D Origin(DungeonCenter.X, DungeonCenter.Y);
+	CorridorSegments.Reset();
+	for (const FCorridorSeg& S : CurrentLayout.Corridors)
+		CorridorSegments.Emplace(Origin + S.A, Origin + S.B, S.ZA, S.ZB);
+	if (bBuildCorridors) SpawnCorridorMeshes();
+
+	// Tous les couloirs ont pu bouger : props de toutes les salles refaits, comme chez le client
+	FDungeonPipeline::PopulateRooms(P, CurrentLayout);
+	SpawnProps();
+
+	bIncrementalReady = false;
+	RoomVertex.Reset();
+	VertexRooms.Reset();
+	CorridorSlots.Reset();
+	FreeCorridorSlots.Reset();
+}
+
+void ADungeonGenerator::EmitCorridor(const FDungeonGenParams& P, const FDGEdge& E, TArray<FCorridorSeg>* Changed)
+{
+	if (!P.bBuildCorridors) return;
+
+	TArray<FCorridorSeg> Segs;
+	FDungeonPipeline::BuildCorridor(P, VertexRooms[E.A], VertexRooms[E.B], Segs);
+
+	const FVector2D Origin(DungeonCenter.X, DungeonCenter.Y);
+	TArray<int32, TInlineAllocator<2>>& Slots = CorridorSlots.Add(E);
+	for (const FCorridorSeg& S : Segs)
+	{
+		const FCorridorSeg World(Origin + S.A, Origin + S.B, S.ZA, S.ZB);
+		FTransform Xform(FQuat::Identity, FVector::ZeroVector, FVector::ZeroVector); // longueur nulle : instance masquée
+		MakeCorridorTransform(World, Xform);
+
+		int32 Slot;
+		if (FreeCorridorSlots.Num() > 0)
+		{
+			Slot = FreeCorridorSlots.Pop(EAllowShrinking::No);
+			CorridorSegments[Slot] = World;
+			CurrentLayout.Corridors[Slot] = S;
+			CorridorGrid.Add(Slot, S);
+			if (CorridorISM) CorridorISM->UpdateInstanceTransform(Slot, Xform, true, false);
+		}
+		else
 		{
-			DrawDebugString(W, P + FVector(0,0,CenterMarkerHalfExtent.Z + 20.f),
-				FString::Printf(TEXT("#%d"), i), nullptr, FColor::Cyan, DebugDuration, true, 1.6f);
+			Slot = CorridorSegments.Add(World);
+			CurrentLayout.Corridors.Add(S);
+			CorridorGrid.Add(Slot, S);
+			if (CorridorISM) CorridorISM->AddInstance(Xform, true);
 		}
+		Slots.Add(Slot);
+		if (Changed) Changed->Add(S);
 	}
 }
-static void CircumCenterRadius(const FVector2D& A, const FVector2D& B, const FVector2D& C, FVector2D& O, float& R2)
+
+void ADungeonGenerator::ReleaseCorridor(const FDGEdge& E, TArray<FCorridorSeg>& Changed)
 {
-	const float D = 2.f*(A.X*(B.Y-C.Y)+B.X*(C.Y-A.Y)+C.X*(A.Y-B.Y));
-	if (FMath::IsNearlyZero(D)) { O = FVector2D(FLT_MAX, FLT_MAX); R2 = FLT_MAX; return; }
+	TArray<int32, TInlineAllocator<2>> Slots;
+	if (!CorridorSlots.RemoveAndCopyValue(E, Slots)) return;
 
-	const float A2 = A.SizeSquared(), B2 = B.SizeSquared(), C2 = C.SizeSquared();
-	O.X = (A2*(B.Y-C.Y) + B2*(C.Y-A.Y) + C2*(A.Y-B.Y)) / D;
-	O.Y = (A2*(C.X-B.X) + B2*(A.X-C.X) + C2*(B.X-A.X)) / D;
-	R2  = (O - A).SizeSquared();
+	// L'instance est masquée plutôt que retirée : les indices des autres instances ne bougent pas
+	const FTransform Hidden(FQuat::Identity, FVector::ZeroVector, FVector::ZeroVector);
+	const FCorridorSeg Empty(FVector2D::ZeroVector, FVector2D::ZeroVector);
+	for (int32 Slot : Slots)
+	{
+		if (CorridorISM) CorridorISM->UpdateInstanceTransform(Slot, Hidden, true, false);
+		CorridorGrid.Remove(Slot, CurrentLayout.Corridors[Slot]);
+		Changed.Add(CurrentLayout.Corridors[Slot]);
+		CorridorSegments[Slot] = Empty;
+		CurrentLayout.Corridors[Slot] = Empty;
+		FreeCorridorSlots.Add(Slot);
+	}
 }
 
-bool ADungeonGenerator::PointInCircumcircle(const FVector2D& P, const FVector2D& A, const FVector2D& B, const FVector2D& C) const
+void ADungeonGenerator::ApplyGraphDelta(const FDungeonGenParams& P, const FDungeonIncrementalGraph::FDelta& Delta, TArray<FCorridorSeg>& Changed)
 {
-	FVector2D O; float R2; CircumCenterRadius(A,B,C,O,R2);
-	if (R2 == FLT_MAX) return false;
-	return (P - O).SizeSquared() <= R2;
+	for (const FDGEdge& E : Delta.RemovedEdges) ReleaseCorridor(E, Changed);
+	for (const FDGEdge& E : Delta.AddedEdges) EmitCorridor(P, E, &Changed);
+	if (CorridorISM) CorridorISM->MarkRenderStateDirty();
+
+	// MST du layout en indices de main rooms (l'ordre des ids suit celui des main rooms) ; les triangles,
+	// données de debug seulement, sont exportés au flush et seulement s'ils sont dessinés
+	TArray<int32> MainOfVertex;
+	BuildMainOfVertex(MainOfVertex);
+
+	TArray<FDGEdge> Edges;
+	IncrementalGraph.GetMSTEdges(Edges);
+	CurrentLayout.MSTEdges.Reset(Edges.Num());
+	for (const FDGEdge& E : Edges) CurrentLayout.MSTEdges.Emplace(MainOfVertex[E.A], MainOfVertex[E.B]);
+
+	CurrentLayout.DelaunayTriangles.Reset();
+	bTrianglesStale = !P.bCompactLayout;
 }
 
-void ADungeonGenerator::BuildDelaunay()
+void ADungeonGenerator::BuildMainOfVertex(TArray<int32>& Out) const
 {
-	DelaunayTriangles.Reset();
-	if (Points2D.Num() < 3) return;
-
-	FBox2D BB(Points2D[0], Points2D[0]); for (const auto& P : Points2D) BB += P;
-	const float delta = FMath::Max(BB.Max.X - BB.Min.X, BB.Max.Y - BB.Min.Y) * 10.f;
-	const FVector2D mid = (BB.Min + BB.Max) * 0.5f;
+	// Index de main room de chaque sommet du graphe : les ids suivent l'ordre des main rooms
+	Out.Init(INDEX_NONE, VertexRooms.Num());
+	int32 MainIndex = 0;
+	for (int32 i = 0; i < CurrentLayout.Rooms.Num(); ++i)
+	{
+		if (!CurrentLayout.Rooms[i].bIsMain) continue;
+		if (RoomVertex[i] != INDEX_NONE) Out[RoomVertex[i]] = MainIndex;
+		++MainIndex;
+	}
+}
 
-	const FVector2D S1(mid.X - 2*delta, mid.Y - delta);
-	const FVector2D S2(mid.X,            mid.Y + 2*delta);
-	const FVector2D S3(mid.X + 2*delta,  mid.Y - delta);
+void ADungeonGenerator::ExportIncrementalTriangles()
+{
+	bTrianglesStale = false;
+	if (!bIncrementalReady) return;
 
-	TArray<FVector2D> Pts = Points2D;
-	const int32 iS1 = Pts.Add(S1), iS2 = Pts.Add(S2), iS3 = Pts.Add(S3);
+	TArray<int32> MainOfVertex;
+	BuildMainOfVertex(MainOfVertex);
 
 	TArray<FDGTriangle> Tris;
-	Tris.Add(FDGTriangle(iS1, iS2, iS3));
+	IncrementalGraph.GetTriangles(Tris);
+	CurrentLayout.DelaunayTriangles.Reset(Tris.Num());
+	for (const FDGTriangle& T : Tris)
+		CurrentLayout.DelaunayTriangles.Emplace(MainOfVertex[T.I], MainOfVertex[T.J], MainOfVertex[T.K]);
+}
+
+void ADungeonGenerator::RepopulateRoomsNear(const FDungeonGenParams& P, const TArray<FCorridorSeg>& Changed, int32 SkipRoom)
+{
+	if (!PropSet || !P.Props.IsEnabled() || Changed.Num() == 0) return;
+
+	// Salles dont le dégagement a changé : un couloir ajouté ou retiré passe dans leur marge.
+	// Même test que PopulateRoom, donc mêmes props que la reconstruction complète du client.
+	FBox2D Bounds(ForceInit);
+	for (const FCorridorSeg& S : Changed) { Bounds += S.A; Bounds += S.B; }
 
-	for (int32 idx = 0; idx < Points2D.Num(); ++idx)
+	TArray<FDungeonRoomDesc, TInlineAllocator<16>> Affected;
+	for (int32 r = 0; r < CurrentLayout.Rooms.Num(); ++r)
 	{
-		const FVector2D& P = Points2D[idx];
+		const FDungeonRoomDesc& Room = CurrentLayout.Rooms[r];
+		if (r == SkipRoom) continue;
+		const FVector2D Reach = Room.Size * 0.5 + FVector2D(P.Props.CorridorClearance);
+		if (!Bounds.Intersect(FBox2D(Room.Center - Reach, Room.Center + Reach))) continue;
 
-		TArray<int32> Bad;
-		for (int32 t = 0; t < Tris.Num(); ++t)
+		for (const FCorridorSeg& S : Changed)
 		{
-			const FDGTriangle& T = Tris[t];
-			if (PointInCircumcircle(P, Pts[T.I], Pts[T.J], Pts[T.K])) Bad.Add(t);
+			FVector2D A, B;
+			if (FDungeonPipeline::ClipCorridorToRoom(P, Room, S, A, B)) { Affected.Add(Room); break; }
 		}
+	}
+	if (Affected.Num() == 0) return;
 
-		TMap<FDGEdge, int32> EdgeCount;
-		for (int32 tIndex : Bad)
-		{
-			const FDGTriangle& T = Tris[tIndex];
-			EdgeCount.FindOrAdd(FDGEdge(T.I,T.J))++;
-			EdgeCount.FindOrAdd(FDGEdge(T.J,T.K))++;
-			EdgeCount.FindOrAdd(FDGEdge(T.K,T.I))++;
-		}
+	HideRoomProps(Affected);
+	FInstanceBatch Batch;
+	for (const FDungeonRoomDesc& Room : Affected) SpawnRoomProps(P, Room, Batch);
+	ApplyInstanceBatch(Batch);
+}
 
-		Bad.Sort();
-		for (int32 i = Bad.Num()-1; i >= 0; --i) Tris.RemoveAt(Bad[i]);
+void ADungeonGenerator::SpawnRoomProps(const FDungeonGenParams& P, const FDungeonRoomDesc& Room, FInstanceBatch& Batch)
+{
+	if (!PropSet || !P.Props.IsEnabled()) return;
 
-		for (const auto& KV : EdgeCount)
-			if (KV.Value == 1) Tris.Add(FDGTriangle(KV.Key.A, KV.Key.B, idx));
-	}
+	// Grille tenue à jour par EmitCorridor / ReleaseCorridor : les emplacements libérés n'y sont pas
+	TArray<FDungeonProp> Props;
+	FDungeonPipeline::PopulateRoom(P, CurrentLayout.Seed, Room, CurrentLayout.Corridors, CorridorGrid, Props);
+	if (Props.Num() == 0) return;
 
-	for (int32 i = Tris.Num()-1; i >= 0; --i)
+	LLM_SCOPE_BYTAG(Dungeon_Rooms);
+	TArray<int32> ComponentOfRule;
+	ResolvePropComponents(P.Props, ComponentOfRule);
+	for (const FDungeonProp& Prop : Props)
 	{
-		const FDGTriangle& T = Tris[i];
-		if (T.I >= Points2D.Num() || T.J >= Points2D.Num() || T.K >= Points2D.Num())
-			Tris.RemoveAt(i);
-	}
+		if (!ComponentOfRule.IsValidIndex(Prop.Rule) || ComponentOfRule[Prop.Rule] == INDEX_NONE) continue;
+		const int32 c = ComponentOfRule[Prop.Rule];
 
-	DelaunayTriangles = Tris;
+		// Instance masquée par HideRoomProps réutilisée d'abord : le HISM ne grossit pas au fil des éditions
+		if (FreePropSlots.IsValidIndex(c) && FreePropSlots[c].Num() > 0)
+		{
+			const int32 Slot = FreePropSlots[c].Pop(EAllowShrinking::No);
+			Batch.Add(PropHISMs[c], Slot, MakePropTransform(Prop));
+			PropInstances.Emplace(c, Slot);
+		}
+		else
+		{
+			PropInstances.Emplace(c, PropHISMs[c]->AddInstance(MakePropTransform(Prop), true));
+		}
+		CurrentLayout.Props.Add(Prop);
+	}
 }
 
-void ADungeonGenerator::EdgesFromTriangles()
+void ADungeonGenerator::HideRoomProps(TArrayView<const FDungeonRoomDesc> Rooms)
 {
-	GraphEdges.Reset();
-	for (const FDGTriangle& T : DelaunayTriangles)
+	if (PropInstances.Num() != CurrentLayout.Props.Num() || Rooms.Num() == 0) return;
+
+	// Un seul passage sur les props pour toutes les salles, chaque HISM touché n'est invalidé qu'une fois
+	const FTransform Hidden(FQuat::Identity, FVector::ZeroVector, FVector::ZeroVector);
+	FInstanceBatch Batch;
+	for (int32 i = CurrentLayout.Props.Num() - 1; i >= 0; --i)
 	{
-		GraphEdges.Add(FDGEdge(T.I, T.J));
-		GraphEdges.Add(FDGEdge(T.J, T.K));
-		GraphEdges.Add(FDGEdge(T.K, T.I));
+		const FDungeonProp& Prop = CurrentLayout.Props[i];
+		const bool bInside = Rooms.ContainsByPredicate([&Prop](const FDungeonRoomDesc& Room)
+		{
+			return Prop.Floor == Room.Floor && FBox2D(Room.Center - Room.Size * 0.5, Room.Center + Room.Size * 0.5).IsInside(Prop.Position);
+		});
+		if (!bInside) continue;
+
+		const FIntPoint Slot = PropInstances[i];
+		if (PropHISMs.IsValidIndex(Slot.X) && PropHISMs[Slot.X])
+		{
+			Batch.Add(PropHISMs[Slot.X], Slot.Y, Hidden);
+			if (FreePropSlots.Num() <= Slot.X) FreePropSlots.SetNum(Slot.X + 1);
+			FreePropSlots[Slot.X].Add(Slot.Y);
+		}
+		CurrentLayout.Props.RemoveAtSwap(i, 1, EAllowShrinking::No);
+		PropInstances.RemoveAtSwap(i, 1, EAllowShrinking::No);
 	}
+	ApplyInstanceBatch(Batch);
 }
 
-void ADungeonGenerator::BuildMST_Prim()
+void ADungeonGenerator::FinishRuntimeEdit()
 {
-	MSTEdges.Reset();
-	const int32 N = Points2D.Num();
-	if (N <= 1) return;
+	// Le reste est en O(salles) : fait une fois par frame, quel que soit le nombre d'éditions
+	if (bRuntimeEditPending) return;
+	bRuntimeEditPending = true;
+	GetWorldTimerManager().SetTimerForNextTick(this, &ADungeonGenerator::FlushRuntimeEdits);
+}
 
-	TSet<int32> Visited; Visited.Add(0);
+void ADungeonGenerator::FlushRuntimeEdits()
+{
+	if (!bRuntimeEditPending) return; // BuildFromLayout est passé entre-temps
+	bRuntimeEditPending = false;
+	const double StartTime = FPlatformTime::Seconds();
 
-	while (Visited.Num() < N)
-	{
-		float Best = TNumericLimits<float>::Max();
-		FDGEdge BestE; int32 Next = INDEX_NONE;
+#if UE_ENABLE_DEBUG_DRAWING
+	if (bTrianglesStale && bDrawDelaunay) ExportIncrementalTriangles();
+#endif
+	CollectAndStoreMainCenters();
+	DrawMainCenters();
+	DrawDebugViz();
+	if (bBuildCorridors) DrawCorridorsDebug();
 
-		for (const FDGEdge& E : GraphEdges)
-		{
-			const bool aIn = Visited.Contains(E.A);
-			const bool bIn = Visited.Contains(E.B);
-			if (aIn == bIn) continue;
+	RebuildPortalGraph();
+	LastStats.SpawnBytes = MeasureSpawnBytes();
+	BuildProxiesAsync();
+	PublishLayout();
 
-			const float d = (Points2D[E.A] - Points2D[E.B]).Size();
-			if (d < Best) { Best = d; BestE = E; Next = aIn ? E.B : E.A; }
-		}
+	UE_LOG(LogDungeon, Log, TEXT("Runtime edits flushed in %.2f ms (portal graph, proxies, layout publish)"),
+		(FPlatformTime::Seconds() - StartTime) * 1000.0);
+}
 
-		if (Next == INDEX_NONE) break;
-		MSTEdges.Add(BestE);
-		Visited.Add(Next);
+void ADungeonGenerator::RefreshMainRoomMaterials()
+{
+	UMaterialInterface* Material = MainRoomMaterial.Get();
+	if (!Material) return;
+	for (ARoom* R : SpawnedRooms)
+	{
+		if (!IsValid(R) || !IsValid(R->VisualMesh)) continue;
+		if (R->bIsMain) R->VisualMesh->SetMaterial(0, Material);
 	}
 }
 
-void ADungeonGenerator::DrawDebugViz()
+FDungeonGenParams ADungeonGenerator::MakeGenParams() const
 {
-	if (!bDrawDelaunay) return;
-	UWorld* W = GetWorld(); if (!W) return;
+	FDungeonGenParams P;
+	P.RoomsNbr                 = RoomsNbr;
+	P.RoomSizeMin              = RoomSizeMin;
+	P.RoomSizeMax              = RoomSizeMax;
+	P.SpawnRadius              = SpawnRadius;
+	P.PlacementMode            = PlacementMode;
+	P.PoissonCandidates        = PoissonCandidates;
+	P.FloorCount               = FMath::Max(1, FloorCount);
+	P.FloorHeight              = FloorHeight;
+	P.MaxRelaxIterations       = MaxRelaxIterations;
+	P.NudgeClamp               = NudgeClamp;
+	P.ContactPadding           = ContactPadding;
+	P.bEnableCulling           = bEnableCulling;
+	P.CullPenetrationThreshold = CullPenetrationThreshold;
+	P.MaxCulls                 = MaxCulls;
+	P.MainCount                = MainCount;
+	P.MinMainGap               = MinMainGap;
+	P.ClusterCount             = ClusterCount;
+	P.bBuildCorridors          = bBuildCorridors;
+	P.bKeepOnlyMainAndPath     = bKeepOnlyMainAndPath;
+	P.CorridorKeepDistance     = CorridorKeepDistance;
+	P.bCorridorFollowMSTExact  = bCorridorFollowMSTExact;
+	P.bCompactLayout           = bCompactRooms;
+	if (PropSet) PropSet->ToRules(P.Props);
+	return P;
+}
 
-	const float Z_Del = DungeonCenter.Z + DelaunayZDebugOffset;
-	const float Z_MST = DungeonCenter.Z + MSTZDebugOffset;
+uint32 ADungeonGenerator::ComputeParamHash() const
+{
+	uint32 H = MakeGenParams().GetHash();
+	H = HashCombine(H, GetTypeHash(RoomClass.ToString()));
+	H = HashCombine(H, GetTypeHash(CorridorMesh.ToString()));
+	H = HashCombine(H, GetTypeHash(CorridorZOffset));
+	H = HashCombine(H, GetTypeHash(CorridorWidth));
+	H = HashCombine(H, GetTypeHash(CorridorHeight));
+	H = HashCombine(H, GetTypeHash(RoomHeight));
+	H = HashCombine(H, GetTypeHash(GetPathNameSafe(PropSet.Get())));
+	return H;
+}
 
-	for (const FDGTriangle& T : DelaunayTriangles)
+void ADungeonGenerator::PublishLayout()
+{
+	ReplicatedLayout.Seed      = CurrentLayout.Seed;
+	ReplicatedLayout.ParamHash = CurrentLayout.ParamHash;
+	ReplicatedLayout.DerivedCrc = CurrentLayout.ComputeDerivedCrc();
+	++ReplicatedLayout.LayoutId;
+
+	TArray<uint8> Bytes;
+	CurrentLayout.Pack(Bytes);
+	ReplicatedLayout.Packed.Reset();
+	StreamedBytes.Reset();
+	if (Bytes.Num() > FDungeonLayoutNet::MaxStreamedBytes)
 	{
-		const FVector A(Points2D[T.I].X, Points2D[T.I].Y, Z_Del);
-		const FVector B(Points2D[T.J].X, Points2D[T.J].Y, Z_Del);
-		const FVector C(Points2D[T.K].X, Points2D[T.K].Y, Z_Del);
-		DrawDebugLine(W, A, B, FColor::Blue,  true, DebugDuration, 0, 6.f);
-		DrawDebugLine(W, B, C, FColor::Blue,  true, DebugDuration, 0, 6.f);
-		DrawDebugLine(W, C, A, FColor::Blue,  true, DebugDuration, 0, 6.f);
+		ReplicatedLayout.TotalBytes = 0;
+		UE_LOG(LogDungeon, Error, TEXT("Dungeon layout too large to replicate: %d rooms, %d bytes (limit %d)"),
+			CurrentLayout.Rooms.Num(), Bytes.Num(), FDungeonLayoutNet::MaxStreamedBytes);
+		return;
 	}
 
-	for (const FDGEdge& E : MSTEdges)
+	ReplicatedLayout.TotalBytes = Bytes.Num();
+	if (ReplicatedLayout.IsStreamed())
+	{
+		// Trop gros pour une propriété : la propriété n'annonce que l'id et la taille, les octets suivent par RPC fiables
+		StreamedBytes = MoveTemp(Bytes);
+		for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+			UDungeonLayoutStreamComponent::StreamTo(It->Get(), this);
+	}
+	else
 	{
-		const FVector A(Points2D[E.A].X, Points2D[E.A].Y, Z_MST);
-		const FVector B(Points2D[E.B].X, Points2D[E.B].Y, Z_MST);
-		DrawDebugLine(W, A, B, FColor::Green, true, DebugDuration, 0, 12.f);
+		ReplicatedLayout.Packed = MoveTemp(Bytes);
 	}
+
+	UE_LOG(LogDungeon, Log, TEXT("Dungeon layout %d published: seed %d, %d rooms, %d edges, %d bytes%s, corridors/props crc %08x"),
+		ReplicatedLayout.LayoutId, CurrentLayout.Seed, CurrentLayout.Rooms.Num(), CurrentLayout.MSTEdges.Num(), ReplicatedLayout.TotalBytes,
+		ReplicatedLayout.IsStreamed() ? TEXT(" (streamed)") : TEXT(""), ReplicatedLayout.DerivedCrc);
+}
+
+void ADungeonGenerator::OnPlayerLogin(AGameModeBase* GameMode, APlayerController* NewPlayer)
+{
+	if (StreamedBytes.Num() > 0) UDungeonLayoutStreamComponent::StreamTo(NewPlayer, this);
 }
 
-bool ADungeonGenerator::SegmentIntersectsAABB2D(
-	const FVector2D& P0, const FVector2D& P1,
-	const FVector2D& Center, const FVector2D& Half)
+void ADungeonGenerator::CommitLayout(FDungeonLayout&& Layout, bool bPublish)
 {
-	const double minX = static_cast<double>(Center.X - Half.X);
-	const double maxX = static_cast<double>(Center.X + Half.X);
-	const double minY = static_cast<double>(Center.Y - Half.Y);
-	const double maxY = static_cast<double>(Center.Y + Half.Y);
+	// Construction hors BeginPlay (SelectMainRooms dans l'éditeur) : la requête part d'ici
+	if (!bAssetsRequested) RequestAssets();
 
-	const double dx = static_cast<double>(P1.X - P0.X);
-	const double dy = static_cast<double>(P1.Y - P0.Y);
+	if (!PendingLayout.IsSet()) PendingSince = FPlatformTime::Seconds();
+	PendingLayout = MoveTemp(Layout);
+	bPendingPublish = bPublish;
 
-	double p[4] = { -dx, dx, -dy, dy };
-	double q[4] = {
-		static_cast<double>(P0.X) - minX,
-		maxX - static_cast<double>(P0.X),
-		static_cast<double>(P0.Y) - minY,
-		maxY - static_cast<double>(P0.Y)
-	};
+	// Jamais d'attente bloquante sur le game thread : OnAssetsLoaded reprendra la construction
+	if (AreAssetsReady()) FlushPendingLayout();
+	else UE_LOG(LogDungeon, Log, TEXT("Dungeon build deferred until its %d assets are loaded"), AssetCount);
+}
+
+void ADungeonGenerator::FlushPendingLayout()
+{
+	if (!PendingLayout.IsSet()) return;
+	const FDungeonLayout Layout = MoveTemp(PendingLayout.GetValue());
+	PendingLayout.Reset();
+
+	if (AssetLoadMs <= 0.0 && AssetCount > 0) AssetLoadMs = (FPlatformTime::Seconds() - AssetRequestTime) * 1000.0;
+	LastStats.Assets = AssetCount;
+	LastStats.AssetLoadMs = AssetLoadMs;
+	LastStats.AssetWaitMs = (FPlatformTime::Seconds() - PendingSince) * 1000.0;
+
+	if (!CheckAssets()) return;
 
-	double u0 = 0.0, u1 = 1.0;
-	for (int i = 0; i < 4; ++i)
+	BuildFromLayout(Layout);
+	if (!bPendingPublish) return;
+
+	PublishLayout();
+	UE_LOG(LogDungeon, Log, TEXT("Dungeon memory: %s"), *LastStats.MemoryToString());
+}
+
+void ADungeonGenerator::BuildFromLayout(const FDungeonLayout& Layout)
+{
+	// Assets chargés : seul FlushPendingLayout construit
+	ClearDungeon();
+	CurrentLayout = Layout;
+	CurrentLayout.ParamHash = ComputeParamHash();
+	ActiveSeed = Layout.Seed;
+
+	const FVector2D Origin(DungeonCenter.X, DungeonCenter.Y);
 	{
-		if (FMath::IsNearlyZero(p[i]))
+		LLM_SCOPE_BYTAG(Dungeon_Rooms);
+		if (bCompactRooms)
 		{
-			if (q[i] < 0.0) return false;
+			SpawnRoomInstances(Layout);
 		}
 		else
 		{
-			const double t = q[i] / p[i];
-			if (p[i] < 0.0) { if (t > u1) return false; if (t > u0) u0 = t; }
-			else            { if (t < u0) return false; if (t < u1) u1 = t; }
+			for (const FDungeonRoomDesc& D : Layout.Rooms)
+			{
+				if (ARoom* Room = SpawnRoom(Origin + D.Center, D.Size, D.Floor))
+					Room->bIsMain = D.bIsMain;
+			}
 		}
 	}
-	return true;
-}
 
-static bool ClipSegmentAgainstAABB2D(
-	const FVector2D& P0, const FVector2D& P1,
-	const FVector2D& Center, const FVector2D& Half,
-	double& OutU0, double& OutU1)
-{
-	const double minX = Center.X - Half.X;
-	const double maxX = Center.X + Half.X;
-	const double minY = Center.Y - Half.Y;
-	const double maxY = Center.Y + Half.Y;
+	RefreshMainRoomMaterials();
+	CollectAndStoreMainCenters();
+	DrawMainCenters();
+	DrawDebugViz();
 
-	const double dx = static_cast<double>(P1.X - P0.X);
-	const double dy = static_cast<double>(P1.Y - P0.Y);
+	CorridorSegments.Reset();
+	for (const FCorridorSeg& S : Layout.Corridors)
+		CorridorSegments.Emplace(Origin + S.A, Origin + S.B, S.ZA, S.ZB);
+	CorridorGrid.Build(CurrentLayout.Corridors);
 
-	double p[4] = { -dx, dx, -dy, dy };
-	double q[4] = {
-		static_cast<double>(P0.X) - minX,
-		maxX - static_cast<double>(P0.X),
-		static_cast<double>(P0.Y) - minY,
-		maxY - static_cast<double>(P0.Y)
-	};
+	if (bBuildCorridors)
+	{
+		DrawCorridorsDebug();
+		SpawnCorridorMeshes();
+	}
+	SpawnProps();
+	RebuildPortalGraph();
 
-	double u0 = 0.0, u1 = 1.0;
-	for (int i = 0; i < 4; ++i)
+	LastStats.SpawnBytes = MeasureSpawnBytes();
+	BuildProxiesAsync();
+}
+
+void ADungeonGenerator::BuildProxiesAsync()
+{
+	if (ProxyDistance <= 0.f || GetNetMode() == NM_DedicatedServer) return;
+
+	// Boîtes relevées sur le game thread, en repère acteur : la fusion elle-même part en tâche de fond
+	const FTransform ActorXform = GetActorTransform();
+	TArray<FTransform> Boxes;
+	Boxes.Reserve(CurrentLayout.Rooms.Num() + CorridorSegments.Num());
+	for (const FDungeonRoomDesc& D : CurrentLayout.Rooms)
+		Boxes.Add(MakeRoomTransform(D).GetRelativeTransform(ActorXform));
+	if (bBuildCorridors)
 	{
-		if (FMath::IsNearlyZero(p[i]))
+		for (const FCorridorSeg& S : CorridorSegments)
 		{
-			if (q[i] < 0.0) return false;
+			FTransform Xform;
+			if (MakeCorridorTransform(S, Xform))
+				Boxes.Add(Xform.GetRelativeTransform(ActorXform));
 		}
-		else
+	}
+	if (Boxes.Num() == 0) return;
+
+	const int32 BuildId = ++ProxyBuildId; // seule la dernière construction lancée sera appliquée
+	const float CellSize = ProxyCellSize;
+	TWeakObjectPtr<ADungeonGenerator> WeakThis(this);
+
+	UE::Tasks::Launch(UE_SOURCE_LOCATION, [WeakThis, BuildId, CellSize, Boxes = MoveTemp(Boxes)]()
+	{
+		TArray<FDungeonProxyCell> Cells;
+		FDungeonProxyBuilder::Build(Boxes, CellSize, Cells);
+
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, BuildId, Cells = MoveTemp(Cells)]() mutable
 		{
-			const double t = q[i] / p[i];
-			if (p[i] < 0.0) { if (t > u1) return false; if (t > u0) u0 = t; }
-			else            { if (t < u0) return false; if (t < u1) u1 = t; }
-		}
+			if (ADungeonGenerator* This = WeakThis.Get())
+				This->ApplyProxies(BuildId, MoveTemp(Cells));
+		});
+	}, UE::Tasks::ETaskPriority::BackgroundNormal);
+}
+
+void ADungeonGenerator::ApplyProxies(int32 BuildId, TArray<FDungeonProxyCell>&& Cells)
+{
+	if (BuildId != ProxyBuildId) return; // donjon régénéré ou vidé entre-temps
+
+	LLM_SCOPE_BYTAG(Dungeon_Rooms);
+	DestroyProxyMeshes(); // proxies d'avant une mise à jour incrémentale, gardés jusqu'ici pour ne pas laisser de trou
+	for (FDungeonProxyCell& Cell : Cells)
+	{
+		UProceduralMeshComponent* Proxy = NewObject<UProceduralMeshComponent>(this);
+		Proxy->SetupAttachment(RootComponent);
+		Proxy->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		Proxy->SetCastShadow(false);
+		Proxy->bUseAsyncCooking = true;
+		Proxy->MinDrawDistance = ProxyDistance; // n'apparaît qu'au-delà de la distance où le détail disparaît
+		Proxy->CreateMeshSection(0, Cell.Vertices, Cell.Triangles, Cell.Normals,
+			TArray<FVector2D>(), TArray<FColor>(), TArray<FProcMeshTangent>(), false);
+		if (UMaterialInterface* Material = ProxyMaterial.Get()) Proxy->SetMaterial(0, Material);
+		Proxy->RegisterComponent();
+		AddInstanceComponent(Proxy);
+		ProxyMeshes.Add(Proxy);
 	}
-	OutU0 = u0; OutU1 = u1;
-	return true;
+
+	// Le détail n'est coupé qu'une fois les proxies en place : pas de trou pendant la construction
+	ApplyCullDistances(ProxyDistance);
+	LastStats.SpawnBytes = MeasureSpawnBytes();
+	UE_LOG(LogDungeon, Log, TEXT("Dungeon HLOD proxies: %d cells of %.0f uu, swap at %.0f uu"),
+		ProxyMeshes.Num(), ProxyCellSize, ProxyDistance);
 }
 
-void ADungeonGenerator::BuildCorridorsFromMST()
+void ADungeonGenerator::ApplyCullDistances(float Distance)
 {
-    CorridorSegments.Reset();
+	const int32 End = FMath::RoundToInt32(Distance);
+	for (ARoom* R : SpawnedRooms)
+		if (IsValid(R) && IsValid(R->VisualMesh)) R->VisualMesh->SetCullDistance(Distance);
+	if (RoomISM) RoomISM->SetCullDistances(0, End);
+	if (MainRoomISM) MainRoomISM->SetCullDistances(0, End);
+	if (CorridorISM) CorridorISM->SetCullDistances(0, End);
+	for (UHierarchicalInstancedStaticMeshComponent* H : PropHISMs)
+		if (H) H->SetCullDistances(0, End);
+}
 
-    auto FindMainRoomByCenter = [&](const FVector2D& C)->ARoom*
-    {
-        ARoom* Best = nullptr; double BestD2 = DBL_MAX;
-        for (ARoom* R : SpawnedRooms)
-        {
-            if (!IsValid(R) || !R->bIsMain) continue;
-            FVector O,E; R->GetActorBounds(false, O, E);
-            const double d2 = (FVector2D(O.X,O.Y) - C).SizeSquared();
-            if (d2 < BestD2) { BestD2 = d2; Best = R; }
-        }
-        return (BestD2 < 1.0) ? Best : nullptr;
-    };
-	
-    auto ExitPointFromRoom = [&](const FVector2D& Start, const FVector2D& Toward,
-                                 const ARoom* Room, float Inset)->FVector2D
-    {
-        if (!IsValid(Room)) return Start;
-
-        FVector O,E; Room->GetActorBounds(false,O,E);
-        const FVector2D C(O.X,O.Y);
-        FVector2D H = Room->SizeXY * 0.5f;
-        H.X = FMath::Max(0.f, H.X - Inset);
-        H.Y = FMath::Max(0.f, H.Y - Inset);
-    	
-        const double minX = C.X - H.X, maxX = C.X + H.X;
-        const double minY = C.Y - H.Y, maxY = C.Y + H.Y;
-        const double dx = (double)Toward.X - (double)Start.X;
-        const double dy = (double)Toward.Y - (double)Start.Y;
-
-        double p[4] = { -dx, dx, -dy, dy };
-        double q[4] = { (double)Start.X - minX, maxX - (double)Start.X,
-                        (double)Start.Y - minY, maxY - (double)Start.Y };
-        double u0=0.0, u1=1.0;
-        for (int i=0;i<4;++i){
-            if (FMath::IsNearlyZero(p[i])) { if (q[i] < 0.0) return Start; }
-            else {
-                const double t = q[i]/p[i];
-                if (p[i] < 0.0) { if (t > u1) return Start; if (t > u0) u0 = t; }
-                else            { if (t < u0) return Start; if (t < u1) u1 = t; }
-            }
-        }
-        return FMath::Lerp(Start, Toward, (float)u1);
-    };
-
-    const float EdgeInset = 10.f;
-    const float EpsAlign  = 1e-2f;
-    for (const FDGEdge& E : MSTEdges)
-    {
-        const FVector2D Acenter = Points2D[E.A];
-        const FVector2D Bcenter = Points2D[E.B];
-
-        ARoom* AR = FindMainRoomByCenter(Acenter);
-        ARoom* BR = FindMainRoomByCenter(Bcenter);
-    	
-        const FVector2D Aedge = ExitPointFromRoom(Acenter, Bcenter, AR, EdgeInset);
-        const FVector2D Bedge = ExitPointFromRoom(Bcenter, Acenter, BR, EdgeInset);
-
-        if (bCorridorFollowMSTExact)
-        {
-            CorridorSegments.Emplace(Aedge, Bedge);
-        }
-        else
-        {
-            const bool AlignedH = FMath::IsNearlyEqual(Acenter.Y, Bcenter.Y, EpsAlign);
-            const bool AlignedV = FMath::IsNearlyEqual(Acenter.X, Bcenter.X, EpsAlign);
-
-            if (AlignedH || AlignedV)
-            {
-                CorridorSegments.Emplace(Aedge, Bedge);
-            }
-            else
-            {
-                FVector2D Corner(Acenter.X, Bcenter.Y);
-                const FVector2D A_to_Corner = ExitPointFromRoom(Acenter, Corner, AR, EdgeInset);
-                const FVector2D Corner_to_B = ExitPointFromRoom(Bcenter, Corner, BR, EdgeInset);
-
-                CorridorSegments.Emplace(A_to_Corner, Corner);
-                CorridorSegments.Emplace(Corner, Corner_to_B);
-            }
-        }
-    }
+void ADungeonGenerator::ClearProxies()
+{
+	++ProxyBuildId;
+	DestroyProxyMeshes();
+	ApplyCullDistances(0.f);
 }
 
+void ADungeonGenerator::DestroyProxyMeshes()
+{
+	for (UProceduralMeshComponent* Proxy : ProxyMeshes)
+	{
+		if (!IsValid(Proxy)) continue;
+		RemoveInstanceComponent(Proxy);
+		Proxy->DestroyComponent();
+	}
+	ProxyMeshes.Reset();
+}
 
-void ADungeonGenerator::DrawCorridorsDebug() const
+void ADungeonGenerator::RebuildPortalGraph()
 {
-	UWorld* W = GetWorld(); if (!W) return;
+	PortalGraph.Reset();
+	PortalShown.Reset();
+	RoomInstances.Reset();
+	CellPropStart.Reset();
+	CellProps.Reset();
+	if (!bPortalCulling || GetNetMode() == NM_DedicatedServer) return;
+
+	PortalGraph.Build(CurrentLayout, CorridorWidth, FloorHeight);
+	PortalShown.Init(true, PortalGraph.Cells.Num());
+
+	const int32 NumRooms = CurrentLayout.Rooms.Num();
+	if (bCompactRooms)
+	{
+		// Instances ajoutées dans l'ordre du layout, main rooms et autres salles séparées
+		int32 NumMain = 0, NumSide = 0;
+		RoomInstances.Reserve(NumRooms);
+		for (const FDungeonRoomDesc& D : CurrentLayout.Rooms)
+			RoomInstances.Add(D.bIsMain ? NumMain++ : NumSide++);
+	}
 
-	const float Z = DungeonCenter.Z + CorridorZOffset;
+	// Props rangés par salle (tri par comptage), pour les masquer avec elle
+	if (PropInstances.Num() == CurrentLayout.Props.Num())
+	{
+		TArray<int32> RoomOfProp;
+		RoomOfProp.SetNumUninitialized(CurrentLayout.Props.Num());
+		CellPropStart.Init(0, NumRooms + 1);
+		for (int32 i = 0; i < CurrentLayout.Props.Num(); ++i)
+		{
+			const FDungeonProp& Prop = CurrentLayout.Props[i];
+			RoomOfProp[i] = PortalGraph.FindRoom(Prop.Position, Prop.Floor);
+			if (RoomOfProp[i] != INDEX_NONE) ++CellPropStart[RoomOfProp[i] + 1];
+		}
+		for (int32 r = 0; r < NumRooms; ++r) CellPropStart[r + 1] += CellPropStart[r];
+		CellProps.SetNumUninitialized(CellPropStart[NumRooms]);
+		TArray<int32> Fill(CellPropStart);
+		for (int32 i = 0; i < RoomOfProp.Num(); ++i)
+			if (RoomOfProp[i] != INDEX_NONE) CellProps[Fill[RoomOfProp[i]]++] = i;
+	}
 
-	for (const FCorridorSeg& S : CorridorSegments)
+	UE_LOG(LogDungeon, Verbose, TEXT("Portal graph: %d cells, %d portals"), PortalGraph.Cells.Num(), PortalGraph.Portals.Num());
+}
+
+void ADungeonGenerator::UpdatePortalVisibility()
+{
+	if (PortalGraph.IsEmpty() || bRuntimeEditPending) return; // graphe pas encore refait après une édition
+
+	TBitArray<> Visible;
+	bool bCulled = false;
+	const APlayerController* PC = GetWorld() ? GetWorld()->GetFirstPlayerController() : nullptr;
+	if (CVarDungeonPortalCulling.GetValueOnGameThread() != 0 && PC && PC->PlayerCameraManager)
+	{
+		const FVector Eye = PC->PlayerCameraManager->GetCameraLocation() - DungeonCenter;
+		const FRotator Rot = PC->PlayerCameraManager->GetCameraRotation();
+		const int32 Floor = (FloorCount > 1) ? FMath::Clamp(FMath::RoundToInt(Eye.Z / FloorHeight), 0, FloorCount - 1) : 0;
+		const double Thickness = (FloorCount > 1) ? RoomHeight : 2000.0;
+
+		// Caméra hors de l'épaisseur des salles (vue de dessus) : rien n'est masqué
+		if (FMath::Abs(Eye.Z - Floor * FloorHeight) <= Thickness)
+		{
+			const double Yaw = FMath::DegreesToRadians(Rot.Yaw);
+			const bool bSteep = FMath::Abs(FRotator::NormalizeAxis(Rot.Pitch)) > 60.f; // le champ horizontal ne suffit plus
+			const float HalfFov = PC->PlayerCameraManager->GetFOVAngle() * 0.5f + PortalFovMargin;
+			const int32 MaxVisits = FMath::Max(4096, 4 * PortalGraph.Cells.Num());
+			bCulled = PortalGraph.ComputeVisible(FVector2D(Eye.X, Eye.Y), Floor, FVector2D(FMath::Cos(Yaw), FMath::Sin(Yaw)),
+				HalfFov, bSteep || HalfFov >= 89.f, MaxVisits, Visible);
+		}
+	}
+	if (!bCulled)
 	{
-		const FVector P0(S.A.X, S.A.Y, Z);
-		const FVector P1(S.B.X, S.B.Y, Z);
-		DrawDebugLine(W, P0, P1, FColor(0, 160, 255), true, DebugDuration, 0, CorridorThickness);
+		ShowAllCells();
+		return;
+	}
 
-		DrawDebugBox(W, P0, FVector(30,30,30), FColor(0,160,255), true, DebugDuration, 0, 6.f);
-		DrawDebugBox(W, P1, FVector(30,30,30), FColor(0,160,255), true, DebugDuration, 0, 6.f);
+	FInstanceBatch Batch;
+	for (int32 c = 0; c < Visible.Num(); ++c)
+	{
+		if (Visible[c] != PortalShown[c]) SetCellHidden(c, !Visible[c], Batch);
 	}
+	PortalShown = MoveTemp(Visible);
+	ApplyInstanceBatch(Batch);
 }
 
-void ADungeonGenerator::KeepMainAndCorridorRooms()
+void ADungeonGenerator::SetCellHidden(int32 Cell, bool bHidden, FInstanceBatch& Batch)
 {
-	if (!bKeepOnlyMainAndPath) return;
+	// Instances masquées par une échelle nulle : leurs indices ne bougent pas
+	const FTransform Hidden(FQuat::Identity, FVector::ZeroVector, FVector::ZeroVector);
+	if (Cell >= PortalGraph.NumRooms)
+	{
+		const int32 s = Cell - PortalGraph.NumRooms;
+		if (!CorridorISM || !CorridorSegments.IsValidIndex(s)) return;
+		FTransform Xform = Hidden;
+		if (!bHidden) MakeCorridorTransform(CorridorSegments[s], Xform);
+		Batch.Add(CorridorISM, s, Xform);
+		return;
+	}
 
-	TSet<ARoom*> KeepSet;
-	
-	for (ARoom* R : SpawnedRooms)
-		if (IsValid(R) && R->bIsMain)
-			KeepSet.Add(R);
-	
-	for (ARoom* R : SpawnedRooms)
+	const FDungeonRoomDesc& D = CurrentLayout.Rooms[Cell];
+	if (bCompactRooms)
 	{
-		if (!IsValid(R)) continue;
+		UInstancedStaticMeshComponent* ISM = D.bIsMain ? MainRoomISM : RoomISM;
+		if (ISM && RoomInstances.IsValidIndex(Cell))
+			Batch.Add(ISM, RoomInstances[Cell], bHidden ? Hidden : MakeRoomTransform(D));
+	}
+	else if (SpawnedRooms.Num() == PortalGraph.NumRooms && IsValid(SpawnedRooms[Cell]))
+	{
+		SpawnedRooms[Cell]->SetActorHiddenInGame(bHidden);
+	}
 
-		FVector Origin, Extent;
-		R->GetActorBounds(false, Origin, Extent);
+	if (!CellPropStart.IsValidIndex(Cell + 1)) return;
+	for (int32 k = CellPropStart[Cell]; k < CellPropStart[Cell + 1]; ++k)
+	{
+		const int32 i = CellProps[k];
+		const FIntPoint Slot = PropInstances[i];
+		if (PropHISMs.IsValidIndex(Slot.X) && PropHISMs[Slot.X])
+			Batch.Add(PropHISMs[Slot.X], Slot.Y, bHidden ? Hidden : MakePropTransform(CurrentLayout.Props[i]));
+	}
+}
+
+void ADungeonGenerator::ShowAllCells()
+{
+	FInstanceBatch Batch;
+	for (int32 c = 0; c < PortalShown.Num(); ++c)
+	{
+		if (PortalShown[c]) continue;
+		SetCellHidden(c, false, Batch);
+		PortalShown[c] = true;
+	}
+	ApplyInstanceBatch(Batch);
+}
 
-		const FVector2D Center(Origin.X, Origin.Y);
-		FVector2D Half(R->SizeXY.X * 0.5f, R->SizeXY.Y * 0.5f);
-		Half.X += CorridorKeepDistance;
-		Half.Y += CorridorKeepDistance;
+void ADungeonGenerator::ApplyInstanceBatch(FInstanceBatch& Batch)
+{
+	// Les cellules voisines ont des indices proches (couloirs par segment, props par salle) :
+	// une plage contiguë = un seul BatchUpdateInstancesTransforms, et seuls les composants touchés sont invalidés
+	TArray<FTransform> Run;
+	for (TPair<UInstancedStaticMeshComponent*, TArray<TPair<int32, FTransform>>>& It : Batch.Updates)
+	{
+		UInstancedStaticMeshComponent* ISM = It.Key;
+		TArray<TPair<int32, FTransform>>& Updates = It.Value;
+		if (!ISM || Updates.Num() == 0) continue;
 
-		for (const FCorridorSeg& S : CorridorSegments)
+		Updates.Sort([](const TPair<int32, FTransform>& A, const TPair<int32, FTransform>& B) { return A.Key < B.Key; });
+		for (int32 k = 0; k < Updates.Num(); )
 		{
-			if (SegmentIntersectsAABB2D(S.A, S.B, Center, Half))
-			{
-				KeepSet.Add(R);
-				break;
-			}
+			const int32 Start = Updates[k].Key;
+			Run.Reset();
+			do { Run.Add(Updates[k].Value); ++k; }
+			while (k < Updates.Num() && Updates[k].Key == Start + Run.Num());
+			ISM->BatchUpdateInstancesTransforms(Start, Run, true, false, false);
 		}
+		ISM->MarkRenderStateDirty();
+	}
+	Batch.Updates.Reset();
+}
+
+void ADungeonGenerator::OnRep_Layout()
+{
+	if (HasAuthority() || !HasActorBegunPlay()) return;
+	RebuildFromReplicatedLayout();
+}
+
+void ADungeonGenerator::ReceiveLayoutChunk(int32 LayoutId, int32 TotalBytes, int32 Offset, const TArray<uint8>& Bytes)
+{
+	if (HasAuthority()) return;
+	if (TotalBytes <= FDungeonLayoutNet::MaxInlineBytes || TotalBytes > FDungeonLayoutNet::MaxStreamedBytes
+		|| Offset < 0 || Bytes.Num() > TotalBytes - Offset)
+	{
+		UE_LOG(LogDungeon, Error, TEXT("Received a malformed dungeon layout chunk (layout %d, %d+%d of %d bytes)"),
+			LayoutId, Offset, Bytes.Num(), TotalBytes);
+		return;
 	}
 
-	for (int32 i = SpawnedRooms.Num()-1; i >= 0; --i)
+	// Un envoi (re)commence toujours à 0 : nouveau layout, ou flux relancé par le serveur
+	if (Offset == 0)
 	{
-		ARoom* R = SpawnedRooms[i];
-		if (!IsValid(R)) { SpawnedRooms.RemoveAt(i); continue; }
-		if (!KeepSet.Contains(R))
-		{
-			R->Destroy();
-			SpawnedRooms.RemoveAt(i);
-		}
+		ReceivedLayoutId = LayoutId;
+		ReceivedOffset = 0;
+		ReceivedBytes.SetNumUninitialized(TotalBytes);
 	}
+	// Flux fiable et ordonné : un morceau hors séquence appartient à un envoi abandonné
+	if (LayoutId != ReceivedLayoutId || Offset != ReceivedOffset || ReceivedBytes.Num() != TotalBytes) return;
+
+	FMemory::Memcpy(ReceivedBytes.GetData() + Offset, Bytes.GetData(), Bytes.Num());
+	ReceivedOffset += Bytes.Num();
+
+	// Propriété déjà reçue : on reconstruit ; sinon OnRep_Layout le fera
+	if (ReceivedOffset == TotalBytes && HasActorBegunPlay()) RebuildFromReplicatedLayout();
 }
 
-void ADungeonGenerator::SpawnCorridorMeshes()
+void ADungeonGenerator::RebuildFromReplicatedLayout()
 {
-	if (!CorridorISM) return;
+	const TArray<uint8>* Bytes = &ReplicatedLayout.Packed;
+	if (ReplicatedLayout.IsStreamed())
+	{
+		// Morceaux pas encore tous arrivés : ReceiveLayoutChunk relancera la reconstruction
+		if (ReceivedLayoutId != ReplicatedLayout.LayoutId || ReceivedOffset != ReplicatedLayout.TotalBytes) return;
+		Bytes = &ReceivedBytes;
+	}
 
-	CorridorISM->ClearInstances();
+	FDungeonLayout Layout;
+	const bool bUnpacked = Layout.Unpack(*Bytes);
+	ReceivedBytes.Empty();
+	ReceivedLayoutId = INDEX_NONE;
+	ReceivedOffset = 0;
+	if (!bUnpacked)
+	{
+		UE_LOG(LogDungeon, Error, TEXT("Received a malformed dungeon layout (layout %d, %d bytes)"), ReplicatedLayout.LayoutId, ReplicatedLayout.TotalBytes);
+		return;
+	}
+	Layout.Seed      = ReplicatedLayout.Seed;
+	Layout.ParamHash = ReplicatedLayout.ParamHash;
 
-	if (CorridorMesh)
+	if (Layout.ParamHash != ComputeParamHash())
 	{
-		CorridorISM->SetStaticMesh(CorridorMesh);
+		UE_LOG(LogDungeon, Warning, TEXT("Dungeon parameters differ from the server's, corridors may not match"));
 	}
-	if (CorridorMaterial && CorridorISM->GetMaterial(0) != CorridorMaterial)
+
+	if (!ResolveMemoryMode(Layout.Rooms.Num())) return;
+
+	const FDungeonGenParams Params = MakeGenParams();
+	if (bBuildCorridors) FDungeonPipeline::BuildCorridors(Params, Layout);
+	FDungeonPipeline::PopulateRooms(Params, Layout);
+
+	// Ce que le client recalcule (couloirs, props) comparé à l'empreinte publiée par le serveur
+	const uint32 LocalCrc = Layout.ComputeDerivedCrc();
+	if (LocalCrc == ReplicatedLayout.DerivedCrc)
 	{
-		CorridorISM->SetMaterial(0, CorridorMaterial);
+		UE_LOG(LogDungeon, Log, TEXT("Dungeon layout rebuilt from server: seed %d, %d rooms, %d corridor segments, %d props, crc %08x"),
+			Layout.Seed, Layout.Rooms.Num(), Layout.Corridors.Num(), Layout.Props.Num(), LocalCrc);
+	}
+	else
+	{
+		UE_LOG(LogDungeon, Error, TEXT("Client corridors/props do not match the server's (crc %08x vs %08x)"),
+			LocalCrc, ReplicatedLayout.DerivedCrc);
 	}
-	
-	const float Base = 100.f;
 
-	for (const FCorridorSeg& S : CorridorSegments)
+	CommitLayout(MoveTemp(Layout), false);
+}
+
+void ADungeonGenerator::GatherAssets(TArray<FSoftObjectPath>& Out) const
+{
+	auto Add = [&Out](const FSoftObjectPath& Path) { if (!Path.IsNull()) Out.AddUnique(Path); };
+	Add(RoomClass.ToSoftObjectPath());
+	Add(MainRoomMaterial.ToSoftObjectPath());
+	if (bBuildCorridors)
+	{
+		Add(CorridorMesh.ToSoftObjectPath());
+		Add(CorridorMaterial.ToSoftObjectPath());
+	}
+	if (ProxyDistance > 0.f) Add(ProxyMaterial.ToSoftObjectPath());
+	if (PropSet)
 	{
-		const FVector2D AB = S.B - S.A;
-		const float Len = AB.Size();
-		if (Len <= KINDA_SMALL_NUMBER) continue;
+		for (const FDungeonPropEntry& E : PropSet->Props)
+			if (E.Weight > 0.f) Add(E.Mesh.ToSoftObjectPath());
+	}
+}
 
-		const FVector Mid(
-			(S.A.X + S.B.X) * 0.5f,
-			(S.A.Y + S.B.Y) * 0.5f,
-			DungeonCenter.Z + CorridorZOffset + (CorridorHeight * 0.5f));
+void ADungeonGenerator::RequestAssets()
+{
+	TArray<FSoftObjectPath> Paths;
+	GatherAssets(Paths);
+
+	if (AssetHandle.IsValid()) AssetHandle->CancelHandle();
+	AssetHandle.Reset();
+	bAssetsRequested = true;
+	AssetCount = Paths.Num();
+	AssetRequestTime = FPlatformTime::Seconds();
+	AssetLoadMs = 0.0;
+	if (Paths.Num() == 0) return;
+
+	// Le handle garde les assets chargés tant que le générateur vit
+	AssetHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(MoveTemp(Paths),
+		FStreamableDelegate::CreateUObject(this, &ADungeonGenerator::OnAssetsLoaded), FStreamableManager::AsyncLoadHighPriority);
+}
+
+void ADungeonGenerator::OnAssetsLoaded()
+{
+	AssetLoadMs = (FPlatformTime::Seconds() - AssetRequestTime) * 1000.0;
+	UE_LOG(LogDungeon, Verbose, TEXT("Dungeon assets loaded: %d in %.2f ms"), AssetCount, AssetLoadMs);
+	FlushPendingLayout();
+}
 
-		const float YawDeg = FMath::RadiansToDegrees(FMath::Atan2(AB.Y, AB.X));
+bool ADungeonGenerator::AreAssetsReady() const
+{
+	return !AssetHandle.IsValid() || AssetHandle->HasLoadCompleted() || AssetHandle->WasCanceled();
+}
 
-		const FTransform Xform(
-			FRotator(0.f, YawDeg, 0.f),
-			Mid,
-			FVector(Len / Base, CorridorWidth / Base, CorridorHeight / Base)
-		);
+bool ADungeonGenerator::CheckAssets() const
+{
+	// Un asset demandé mais absent est une erreur de contenu : signalée, jamais remplacée en silence
+	TArray<FSoftObjectPath> Paths;
+	GatherAssets(Paths);
+	for (const FSoftObjectPath& Path : Paths)
+	{
+		if (!Path.ResolveObject()) UE_LOG(LogDungeon, Error, TEXT("Dungeon asset %s failed to load"), *Path.ToString());
+	}
 
-		CorridorISM->AddInstance(Xform, true);
+	// Sans classe de salle, rien à construire
+	if (!GetRoomClass())
+	{
+		UE_LOG(LogDungeon, Error, TEXT("Dungeon build aborted: room class %s is not loaded"), *RoomClass.ToString());
+		return false;
 	}
+	return true;
 }
 
-void ADungeonGenerator::SelectMainRooms()
+UClass* ADungeonGenerator::GetRoomClass() const
 {
-	for (ARoom* R : SpawnedRooms)
-		if (IsValid(R)) R->bIsMain = false;
-	TArray<ARoom*> Sorted = SpawnedRooms;
-	Sorted.Sort([](const ARoom& A, const ARoom& B){ return A.GetArea() > B.GetArea(); });
-	
-	TArray<ARoom*> Picked; Picked.Reserve(MainCount);
-	for (ARoom* Candidate : Sorted)
+	return RoomClass.IsNull() ? ARoom::StaticClass() : RoomClass.Get();
+}
+
+bool ADungeonGenerator::ResolveMemoryMode(int32 NumRooms)
+{
+	bCompactRooms = false;
+
+	const int32 CVarBudgetMB = CVarDungeonMemoryBudgetMB.GetValueOnGameThread();
+	const int32 BudgetMB = CVarBudgetMB > 0 ? CVarBudgetMB : MemoryBudgetMB;
+	if (BudgetMB <= 0) return true;
+
+	const SIZE_T Budget = static_cast<SIZE_T>(BudgetMB) * 1024 * 1024;
+	FDungeonGenParams P = MakeGenParams();
+
+	P.bCompactLayout = false;
+	const SIZE_T Full = FDungeonPipeline::EstimatePeakBytes(P, NumRooms) + EstimateSpawnBytes(NumRooms, false);
+	if (Full <= Budget) return true;
+
+	P.bCompactLayout = true;
+	const SIZE_T Compact = FDungeonPipeline::EstimatePeakBytes(P, NumRooms) + EstimateSpawnBytes(NumRooms, true);
+	const double ToMB = 1.0 / (1024.0 * 1024.0);
+
+	if (bAllowCompactMode && Compact <= Budget)
 	{
-		bool ok = true;
-		for (ARoom* P : Picked) if (TooCloseAABB(Candidate, P, MinMainGap)) { ok = false; break; }
-		if (ok) { Picked.Add(Candidate); if (Picked.Num() >= MainCount) break; }
+		bCompactRooms = true;
+		UE_LOG(LogDungeon, Warning, TEXT("Dungeon of %d rooms needs ~%.1f MB, over the %d MB budget: using compact mode (~%.1f MB)"),
+			NumRooms, Full * ToMB, BudgetMB, Compact * ToMB);
+		return true;
 	}
 
-	RelaxMainRoomsPositions(Picked);
+	UE_LOG(LogDungeon, Error, TEXT("Dungeon generation refused: %d rooms need ~%.1f MB (~%.1f MB compact%s), over the %d MB memory budget"),
+		NumRooms, Full * ToMB, Compact * ToMB, bAllowCompactMode ? TEXT("") : TEXT(", compact mode disabled"), BudgetMB);
+	return false;
+}
+
+SIZE_T ADungeonGenerator::EstimateSpawnBytes(int32 NumRooms, bool bCompact) const
+{
+	const SIZE_T N = FMath::Max(0, NumRooms);
 
-	for (ARoom* R : Picked) if (IsValid(R)) R->bIsMain = true;
+	// Instance : transform CPU et sa copie côté rendu, du même ordre de grandeur
+	constexpr SIZE_T InstanceBytes = 2 * sizeof(FInstancedStaticMeshInstanceData);
 
-	RefreshMainRoomMaterials();
-	CollectAndStoreMainCenters();
-	DrawMainCenters();
-	BuildDelaunay();
-	EdgesFromTriangles();
-	BuildMST_Prim();
-	DrawDebugViz();
-	
-	if (bBuildCorridors)
+	// Props : borne haute, la plus grande salle possible remplie à la densité demandée
+	SIZE_T PropsPerRoom = 0;
+	if (PropSet && PropSet->MaxPerRoom > 0)
 	{
-		BuildCorridorsFromMST();
-		DrawCorridorsDebug();
-		KeepMainAndCorridorRooms();
-		SpawnCorridorMeshes();
+		const double MaxAreaM2 = FMath::Max(RoomSizeMin.X, RoomSizeMax.X) * FMath::Max(RoomSizeMin.Y, RoomSizeMax.Y) / 10000.0;
+		PropsPerRoom = FMath::Min(PropSet->MaxPerRoom, FMath::CeilToInt32(MaxAreaM2 * PropSet->DensityPerSquareMeter));
 	}
+	const SIZE_T PropBytes = N * PropsPerRoom * (InstanceBytes + sizeof(FDungeonProp));
+
+	if (bCompact) return N * InstanceBytes + PropBytes;
+
+	// Acteur : l'objet salle et ses sous-objets par défaut (composants), d'après le CDO de la classe
+	// Avant la fin du chargement de RoomClass, estimation sur ARoom
+	UClass* Class = GetRoomClass();
+	ARoom* RoomCDO = (Class ? Class : ARoom::StaticClass())->GetDefaultObject<ARoom>();
+	SIZE_T PerRoom = ObjectBytes(RoomCDO);
+	TArray<UObject*> Subobjects;
+	RoomCDO->GetDefaultSubobjects(Subobjects);
+	for (UObject* Sub : Subobjects) PerRoom += ObjectBytes(Sub);
+	return N * PerRoom + PropBytes;
 }
 
-void ADungeonGenerator::RefreshMainRoomMaterials()
+SIZE_T ADungeonGenerator::MeasureSpawnBytes() const
 {
-	if (!MainRoomMaterial) return;
+	SIZE_T PropBytes = 0;
+	for (UHierarchicalInstancedStaticMeshComponent* H : PropHISMs) PropBytes += ObjectBytes(H);
+	for (UProceduralMeshComponent* Proxy : ProxyMeshes) PropBytes += ObjectBytes(Proxy);
+	if (bCompactRooms) return ObjectBytes(RoomISM) + ObjectBytes(MainRoomISM) + PropBytes;
+
+	SIZE_T Bytes = SpawnedRooms.GetAllocatedSize() + PropBytes;
 	for (ARoom* R : SpawnedRooms)
 	{
-		if (!IsValid(R) || !IsValid(R->VisualMesh)) continue;
-		if (R->bIsMain) R->VisualMesh->SetMaterial(0, MainRoomMaterial);
+		if (!IsValid(R)) continue;
+		Bytes += ObjectBytes(R);
+		for (UActorComponent* C : R->GetComponents()) Bytes += ObjectBytes(C);
 	}
+	return Bytes;
 }
@@ -3,37 +3,15 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
 #include "Room.h"
+#include "DungeonTypes.h"
+#include "DungeonLayout.h"
+#include "DungeonPipeline.h"
+#include "DungeonProxyBuilder.h"
+#include "DungeonIncrementalGraph.h"
+#include "DungeonPortalGraph.h"
+#include "DungeonDebugDrawComponent.h"
 #include "DungeonGenerator.generated.h"
 
-struct FDGEdge
-{
-	int32 A = INDEX_NONE;
-	int32 B = INDEX_NONE;
-
-	FDGEdge() = default;
-	FDGEdge(int32 InA, int32 InB)
-	{
-		A = FMath::Min(InA, InB);
-		B = FMath::Max(InA, InB);
-	}
-	bool operator==(const FDGEdge& Other) const { return A == Other.A && B == Other.B; }
-	friend uint32 GetTypeHash(const FDGEdge& E) { return HashCombine(::GetTypeHash(E.A), ::GetTypeHash(E.B)); }
-};
-
-struct FDGTriangle
-{
-	int32 I = INDEX_NONE, J = INDEX_NONE, K = INDEX_NONE;
-	FDGTriangle() = default;
-	FDGTriangle(int32 InI, int32 InJ, int32 InK) : I(InI), J(InJ), K(InK) {}
-};
-
-struct FCorridorSeg
-{
-	FVector2D A, B;
-	FCorridorSeg() {};
-	FCorridorSeg(const FVector2D& InA, const FVector2D& InB) : A(InA), B(InB) {};
-};
-
 UCLASS()
 class TRIANGULATION_BASED_API ADungeonGenerator : public AActor
 {
@@ -45,72 +23,140 @@ public:
 protected:
 	virtual void BeginPlay() override;
 	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 
 private:
-	// ================= Génération des rooms =================
-	void GenerateDungeon();
-	FVector2D RandomPointInDisk(float Radius, FRandomStream& Rng) const;
-
-	// ================= Relaxation Rooms =================
-	struct FRoomRef
+	// Mises à jour d'instances accumulées par composant, appliquées par plages contiguës
+	struct FInstanceBatch
 	{
-		ARoom* Actor = nullptr;
-		FVector2D Center = FVector2D::ZeroVector;
-		FVector2D Half   = FVector2D::ZeroVector;
-		float Area() const { return 4.f * Half.X * Half.Y; }
-		bool IsValid() const { return ::IsValid(Actor); }
+		TMap<class UInstancedStaticMeshComponent*, TArray<TPair<int32, FTransform>>> Updates;
+		void Add(class UInstancedStaticMeshComponent* ISM, int32 Index, const FTransform& Xform) { Updates.FindOrAdd(ISM).Emplace(Index, Xform); }
 	};
 
-	void BuildRoomRefs(TArray<FRoomRef>& Out) const;
-	static bool Overlap(const FRoomRef& A, const FRoomRef& B, float Padding);
-	static FVector2D MTV(const FRoomRef& A, const FRoomRef& B);
-	int32 RelaxOnce(TArray<FRoomRef>& Refs);
-	void ApplyRefs(const TArray<FRoomRef>& Refs);
-
-	// ================= Culling =================
-	void StartDelayedCulling();
-	void DoFinalCulling();
-	void CullResidualOverlaps(TArray<FRoomRef>& Refs);
-
-	// ================= Main Rooms =================
-	static bool TooCloseAABB(const ARoom* A, const ARoom* B, float ExtraGap);
-	void RelaxMainRoomsPositions(const TArray<ARoom*>& Mains);
+	// ================= Génération des rooms =================
+	void ClearDungeon();
+	int32 PickSeed() const;
+	ARoom* SpawnRoom(const FVector2D& Center, const FVector2D& Size, int32 Floor);
+	void SpawnRoomInstances(const FDungeonLayout& Layout);
+	FTransform MakeRoomTransform(const FDungeonRoomDesc& D) const;
+	void BuildRoomRefs(TArray<FDungeonPipeline::FRoomRef>& Out) const;
 
 	// Main rooms
 	void CollectAndStoreMainCenters();
 	void DrawMainCenters() const;
+	void RefreshMainRoomMaterials();
 
 	// ================= Delaunay & Prim =================
-	bool PointInCircumcircle(const FVector2D& P, const FVector2D& A, const FVector2D& B, const FVector2D& C) const;
-	void BuildDelaunay();
-	void EdgesFromTriangles();
-	void BuildMST_Prim();
 	void DrawDebugViz();
 
 	// ================= Corridors =================
-	void BuildCorridorsFromMST();
 	void DrawCorridorsDebug() const;
-	void KeepMainAndCorridorRooms();
 	void SpawnCorridorMeshes();
-	static bool SegmentIntersectsAABB2D(const FVector2D& P0, const FVector2D& P1, const FVector2D& Center, const FVector2D& Half);
+	bool MakeCorridorTransform(const FCorridorSeg& S, FTransform& Out) const;
+
+	// ================= Props =================
+	void SpawnProps();
+	void ResolvePropComponents(const FDungeonPropRules& Rules, TArray<int32>& ComponentOfRule);
+	FTransform MakePropTransform(const FDungeonProp& P) const;
+
+	// ================= Mises à jour incrémentales =================
+	// Changed : segments de couloirs recâblés si le MST repris diffère du MST publié
+	bool EnsureIncrementalGraph(const FDungeonGenParams& P, TArray<FCorridorSeg>& Changed);
+	void RebuildGraphFromLayout(const FDungeonGenParams& P);
+	void EmitCorridor(const FDungeonGenParams& P, const FDGEdge& E, TArray<FCorridorSeg>* Changed = nullptr);
+	void ReleaseCorridor(const FDGEdge& E, TArray<FCorridorSeg>& Changed);
+	// Changed : segments retirés (avant effacement) et ajoutés, repère du layout
+	void ApplyGraphDelta(const FDungeonGenParams& P, const FDungeonIncrementalGraph::FDelta& Delta, TArray<FCorridorSeg>& Changed);
+	void BuildMainOfVertex(TArray<int32>& Out) const; // sommet du graphe -> index de main room
+	void ExportIncrementalTriangles();
+	void RepopulateRoomsNear(const FDungeonGenParams& P, const TArray<FCorridorSeg>& Changed, int32 SkipRoom);
+	void SpawnRoomProps(const FDungeonGenParams& P, const FDungeonRoomDesc& Room, FInstanceBatch& Batch);
+	void HideRoomProps(TArrayView<const FDungeonRoomDesc> Rooms);
+	void FinishRuntimeEdit();
+	void FlushRuntimeEdits();
+
+	// ================= Proxy HLOD =================
+	void BuildProxiesAsync();
+	void ApplyProxies(int32 BuildId, TArray<FDungeonProxyCell>&& Cells);
+	void ApplyCullDistances(float Distance);
+	void ClearProxies();
+	void DestroyProxyMeshes();
+
+	// ================= Visibilité par portails =================
+	void RebuildPortalGraph();
+	void UpdatePortalVisibility();
+	void SetCellHidden(int32 Cell, bool bHidden, FInstanceBatch& Batch);
+	void ShowAllCells();
+	static void ApplyInstanceBatch(FInstanceBatch& Batch);
+
+	// ================= Layout & Réplication =================
+	uint32 ComputeParamHash() const;
+	void CommitLayout(FDungeonLayout&& Layout, bool bPublish);
+	void FlushPendingLayout();
+	void BuildFromLayout(const FDungeonLayout& Layout);
+	void PublishLayout();
+	void RebuildFromReplicatedLayout();
+	UFUNCTION() void OnRep_Layout();
+	void OnPlayerLogin(class AGameModeBase* GameMode, class APlayerController* NewPlayer);
+
+	// ================= Assets =================
+	void GatherAssets(TArray<FSoftObjectPath>& Out) const;
+	void RequestAssets();
+	void OnAssetsLoaded();
+	bool CheckAssets() const;
+	UClass* GetRoomClass() const; // ARoom si RoomClass n'est pas renseignée, nullptr si elle n'est pas chargée
+
+	// ================= Mémoire =================
+	bool ResolveMemoryMode(int32 NumRooms);
+	SIZE_T EstimateSpawnBytes(int32 NumRooms, bool bCompact) const;
+	SIZE_T MeasureSpawnBytes() const;
 
 public:
+	FDungeonGenParams MakeGenParams() const;
+
+	// Layout produit par UDungeonSchedulerSubsystem, appliqué sur le game thread
+	void ApplyScheduledLayout(FDungeonLayout&& Layout, const FDungeonGenStats& Stats);
+	// Classes, meshes et matériaux demandés par RequestAssets tous chargés : un commit construit sans attendre
+	bool AreAssetsReady() const;
+
+	// Layouts au-delà de FDungeonLayoutNet::MaxInlineBytes, envoyés par UDungeonLayoutStreamComponent
+	const TArray<uint8>& GetStreamedLayout() const { return StreamedBytes; } // serveur, vide si le layout tient dans la propriété
+	int32 GetPublishedLayoutId() const { return ReplicatedLayout.LayoutId; }
+	void ReceiveLayoutChunk(int32 LayoutId, int32 TotalBytes, int32 Offset, const TArray<uint8>& Bytes); // client
+
 	UFUNCTION(BlueprintCallable, Category="MainRooms")
 	void SelectMainRooms();
 	UFUNCTION(BlueprintPure, Category="MainRooms")
 	void GetMainRoomCenters(TArray<FVector>& OutCenters) const { OutCenters = MainCenters; }
 
-private:
-	void RefreshMainRoomMaterials();
+	// En cours de partie (serveur) : ajoute ou retire une main room sans tout régénérer.
+	// Seuls le voisinage dans le graphe, les couloirs des arêtes du MST modifiées et les props des salles qu'ils
+	// traversent sont refaits ; la mise à jour du layout reste en O(salles) par édition, et le flush au tick suivant aussi.
+	UFUNCTION(BlueprintCallable, Category="MainRooms|Runtime")
+	int32 InsertMainRoom(FVector2D WorldCenter, FVector2D Size, int32 RoomFloor = 0); // index dans le layout, INDEX_NONE si refusé
+	UFUNCTION(BlueprintCallable, Category="MainRooms|Runtime")
+	bool RemoveMainRoom(int32 RoomIndex);
 
-public:
 	// Rooms
 	UPROPERTY(EditAnywhere, Category="Rooms") int32    RoomsNbr = 32;
 	UPROPERTY(EditAnywhere, Category="Rooms") FVector2D RoomSizeMin = FVector2D(250, 250);
 	UPROPERTY(EditAnywhere, Category="Rooms") FVector2D RoomSizeMax = FVector2D(950, 950);
-	UPROPERTY(EditAnywhere, Category="Rooms") TSubclassOf<ARoom> RoomClass;
+	UPROPERTY(EditAnywhere, Category="Rooms") TSoftClassPtr<ARoom> RoomClass; // chargée en arrière-plan pendant la génération
+	// > 1 : salles générées en ClusterCount groupes parallèles reliés par un MST entre groupes (donjons de milliers de salles)
+	UPROPERTY(EditAnywhere, Category="Rooms", meta=(ClampMin=0)) int32 ClusterCount = 0;
 
 	UPROPERTY(EditAnywhere, Category="Generation") float SpawnRadius = 1600.f;
+	UPROPERTY(EditAnywhere, Category="Generation") EDungeonPlacementMode PlacementMode = EDungeonPlacementMode::UniformDisk;
+	UPROPERTY(EditAnywhere, Category="Generation", meta=(EditCondition="PlacementMode==EDungeonPlacementMode::PoissonDisk", ClampMin=1))
+	int32 PoissonCandidates = 30;
+	UPROPERTY(EditAnywhere, Category="Generation") int32 Seed = 0; // 0 = seed aléatoire
+	UPROPERTY(EditAnywhere, Category="Generation") bool bUsePregeneratedPool = false;
+	UPROPERTY(EditAnywhere, Category="Generation") bool bUseScheduler = true; // génération hors game thread via UDungeonSchedulerSubsystem
+
+	// Floors
+	UPROPERTY(EditAnywhere, Category="Floors", meta=(ClampMin=1)) int32 FloorCount = 1;
+	UPROPERTY(EditAnywhere, Category="Floors", meta=(EditCondition="FloorCount>1")) float FloorHeight = 800.f;
+	UPROPERTY(EditAnywhere, Category="Floors", meta=(EditCondition="FloorCount>1")) float RoomHeight  = 600.f;
 
 	// Relax
 	UPROPERTY(EditAnywhere, Category="Relax") int32 MaxRelaxIterations = 80;
@@ -119,14 +165,13 @@ public:
 
 	// Culling
 	UPROPERTY(EditAnywhere, Category="Culling") bool  bEnableCulling = true;
-	UPROPERTY(EditAnywhere, Category="Culling") float CullingDelaySeconds = 2.0f;
 	UPROPERTY(EditAnywhere, Category="Culling") float CullPenetrationThreshold = 60.f;
 	UPROPERTY(EditAnywhere, Category="Culling") int32 MaxCulls = 2;
 
 	// Main Rooms
 	UPROPERTY(EditAnywhere, Category="MainRooms") int32 MainCount = 7;
 	UPROPERTY(EditAnywhere, Category="MainRooms") float MinMainGap = 120.f;
-	UPROPERTY(EditAnywhere, Category="MainRooms") TObjectPtr<UMaterialInterface> MainRoomMaterial = nullptr;
+	UPROPERTY(EditAnywhere, Category="MainRooms") TSoftObjectPtr<UMaterialInterface> MainRoomMaterial;
 
 	// Debug Centres
 	UPROPERTY(EditAnywhere, Category="MainRooms|Debug") bool  bDrawMainCenters = true;
@@ -138,7 +183,6 @@ public:
 
 	// Debug Delaunay/MST
 	UPROPERTY(EditAnywhere, Category="Graph|Debug") bool  bDrawDelaunay = true;
-	UPROPERTY(EditAnywhere, Category="Graph|Debug") float DebugDuration = 40.f;
 	UPROPERTY(EditAnywhere, Category="Graph|Debug") float DelaunayZDebugOffset = 1200.f;
 	UPROPERTY(EditAnywhere, Category="Graph|Debug") float MSTZDebugOffset      = 1250.f;
 
@@ -150,20 +194,85 @@ public:
 	UPROPERTY(EditAnywhere, Category="Corridors|Debug") float CorridorThickness = 16.f;
 	UPROPERTY(EditAnywhere, Category="Corridors")
 	bool bCorridorFollowMSTExact = false;
-	UPROPERTY(EditAnywhere, Category="Corridors|Mesh") TObjectPtr<class UStaticMesh> CorridorMesh = nullptr;
-	UPROPERTY(EditAnywhere, Category="Corridors|Mesh") TObjectPtr<class UMaterialInterface> CorridorMaterial = nullptr;
+	UPROPERTY(EditAnywhere, Category="Corridors|Mesh") TSoftObjectPtr<class UStaticMesh> CorridorMesh;
+	UPROPERTY(EditAnywhere, Category="Corridors|Mesh") TSoftObjectPtr<class UMaterialInterface> CorridorMaterial;
 	UPROPERTY(EditAnywhere, Category="Corridors|Mesh") float CorridorWidth  = 250.f;
 	UPROPERTY(EditAnywhere, Category="Corridors|Mesh") float CorridorHeight = 150.f;
 
+	// Props : intérieur des salles, un HISM par mesh
+	UPROPERTY(EditAnywhere, Category="Props") TObjectPtr<class UDungeonPropSet> PropSet = nullptr;
+
+	// Memory : au-delà du budget, salles en instances (mode compact) ou génération refusée
+	UPROPERTY(EditAnywhere, Category="Memory", meta=(ClampMin=0)) int32 MemoryBudgetMB = 0; // 0 = illimité ; dungeon.MemoryBudgetMB prime s'il est > 0
+	UPROPERTY(EditAnywhere, Category="Memory") bool bAllowCompactMode = true;
+
+	// HLOD : au-delà de ProxyDistance, un mesh fusionné par cellule remplace salles, couloirs et props
+	UPROPERTY(EditAnywhere, Category="HLOD", meta=(ClampMin=0)) float ProxyDistance = 15000.f; // 0 = pas de proxy
+	UPROPERTY(EditAnywhere, Category="HLOD", meta=(ClampMin=500)) float ProxyCellSize = 5000.f;
+	UPROPERTY(EditAnywhere, Category="HLOD") TSoftObjectPtr<class UMaterialInterface> ProxyMaterial;
+
+	// Visibility : salles, couloirs et props hors de ce que la caméra voit à travers les portails sont masqués
+	UPROPERTY(EditAnywhere, Category="Visibility") bool bPortalCulling = true; // dungeon.PortalCulling 0 le coupe en jeu
+	UPROPERTY(EditAnywhere, Category="Visibility", meta=(ClampMin=0.02)) float PortalUpdateInterval = 0.1f;
+	UPROPERTY(EditAnywhere, Category="Visibility", meta=(ClampMin=0, ClampMax=30)) float PortalFovMargin = 10.f; // degrés, couvre la rotation entre deux mises à jour
+
+	const FDungeonGenStats& GetLastStats() const { return LastStats; }
+
 private:
 	TArray<TObjectPtr<ARoom>> SpawnedRooms;
 	TArray<FVector>   MainCenters;
-	TArray<FVector2D> Points2D;
-	TArray<FDGTriangle> DelaunayTriangles;
-	TSet<FDGEdge>       GraphEdges;
-	TArray<FDGEdge>     MSTEdges;
+	TArray<FVector>   GraphPoints; // centres des main rooms (monde), sommets du graphe de debug
 	TArray<FCorridorSeg> CorridorSegments;
+	FDungeonLayout    CurrentLayout;
+	FDungeonGenStats  LastStats;
 	UPROPERTY(Transient) TObjectPtr<class UInstancedStaticMeshComponent> CorridorISM;
+	UPROPERTY(Transient) TObjectPtr<class UInstancedStaticMeshComponent> RoomISM;     // salles en mode compact
+	UPROPERTY(Transient) TObjectPtr<class UInstancedStaticMeshComponent> MainRoomISM; // main rooms (MainRoomMaterial) en mode compact
+	bool bCompactRooms = false;
+	UPROPERTY(Transient) TArray<TObjectPtr<class UHierarchicalInstancedStaticMeshComponent>> PropHISMs; // réutilisés d'une génération à l'autre
+	UPROPERTY(Transient) TArray<TObjectPtr<class UProceduralMeshComponent>> ProxyMeshes; // un par cellule
+	int32 ProxyBuildId = 0; // invalide les constructions en vol quand le donjon change
+
+	// Graphe incrémental, construit au premier ajout/retrait de main room
+	FDungeonIncrementalGraph IncrementalGraph;
+	bool bIncrementalReady = false;
+	TArray<int32> RoomVertex;             // sommet de chaque salle de CurrentLayout.Rooms, INDEX_NONE hors graphe
+	TArray<FDungeonRoomDesc> VertexRooms; // salle de chaque sommet, par id
+	TMap<FDGEdge, TArray<int32, TInlineAllocator<2>>> CorridorSlots; // instances de CorridorISM de chaque arête du MST (ids)
+	TArray<int32> FreeCorridorSlots;      // instances masquées, réutilisées par les couloirs suivants
+	TArray<FIntPoint> PropInstances;      // (HISM, instance) de chaque prop de CurrentLayout.Props
+	TArray<TArray<int32>> FreePropSlots;  // instances masquées de chaque HISM, réutilisées par SpawnRoomProps
+	FDungeonSegmentGrid CorridorGrid;     // segments en service de CurrentLayout.Corridors, pour SpawnRoomProps
+	bool bRuntimeEditPending = false;     // portails, proxies, publication... à refaire au prochain tick
+	bool bTrianglesStale = false;         // DelaunayTriangles pas encore réexportés depuis le graphe incrémental
+
+	// Graphe de portails et cellules masquées (jamais sur un serveur dédié)
+	FDungeonPortalGraph PortalGraph;
+	TBitArray<> PortalShown;              // état appliqué, par cellule
+	TArray<int32> RoomInstances;          // instance de chaque salle dans RoomISM / MainRoomISM (mode compact)
+	TArray<int32> CellPropStart;          // props de la salle r : CellProps[CellPropStart[r] .. CellPropStart[r + 1])
+	TArray<int32> CellProps;
+	FTimerHandle PortalTimer;
+
+	// Assets référencés par le donjon, chargés en parallèle de la génération et gardés par le handle
+	TSharedPtr<struct FStreamableHandle> AssetHandle;
+	bool   bAssetsRequested = false;
+	int32  AssetCount = 0;
+	double AssetRequestTime = 0.0;
+	double AssetLoadMs = 0.0;
+
+	// Layout en attente de ses assets, construit par OnAssetsLoaded ; le dernier reçu remplace le précédent
+	TOptional<FDungeonLayout> PendingLayout;
+	bool   bPendingPublish = false;
+	double PendingSince = 0.0;
+
+	UPROPERTY(VisibleAnywhere, Category="Debug") TObjectPtr<UDungeonDebugDrawComponent> DebugDraw;
 	FVector DungeonCenter = FVector::ZeroVector;
-	FTimerHandle CullingTimerHandle;
+	int32 ActiveSeed = 0;
+	UPROPERTY(ReplicatedUsing=OnRep_Layout) FDungeonLayoutNet ReplicatedLayout;
+	TArray<uint8> StreamedBytes;      // serveur : layout encodé trop gros pour ReplicatedLayout.Packed
+	TArray<uint8> ReceivedBytes;      // client : morceaux du flux, reconstruits dans l'ordre
+	int32 ReceivedLayoutId = INDEX_NONE;
+	int32 ReceivedOffset = 0;
+	FDelegateHandle LoginHandle;
 };
@@ -0,0 +1,232 @@
+#include "DungeonGeometryKernel.h"
+
+template struct TDungeonKernel<float,  2, FDungeonFastPredicates>;
+template struct TDungeonKernel<float,  3, FDungeonFastPredicates>;
+template struct TDungeonKernel<double, 2, FDungeonFastPredicates>;
+template struct TDungeonKernel<double, 3, FDungeonFastPredicates>;
+template struct TDungeonKernel<float,  2, FDungeonExactPredicates>;
+template struct TDungeonKernel<float,  3, FDungeonExactPredicates>;
+template struct TDungeonKernel<double, 2, FDungeonExactPredicates>;
+template struct TDungeonKernel<double, 3, FDungeonExactPredicates>;
+
+// ================= Arithmétique d'expansions (Shewchuk) =================
+// Une expansion est une somme de doubles sans chevauchement, par magnitude croissante :
+// son signe est celui de sa dernière composante. Ce chemin n'est pris que quand le filtre échoue.
+// Tout repose sur l'arrondi IEEE exact de chaque opération : aucune réassociation permise ici.
+#if defined(_MSC_VER) && !defined(__clang__)
+#pragma float_control(precise, on, push)
+#endif
+
+namespace
+{
+namespace DungeonExact
+{
+	using FExpansion = TArray<double, TInlineAllocator<64>>;
+
+	constexpr double Epsilon  = 1.1102230246251565e-16; // 2^-53
+	constexpr double Splitter = 134217729.0;             // 2^27 + 1
+
+	constexpr double Orient2DBound = (3.0 + 16.0 * Epsilon) * Epsilon;
+	constexpr double Orient3DBound = (7.0 + 56.0 * Epsilon) * Epsilon;
+	constexpr double InCircleBound = (10.0 + 96.0 * Epsilon) * Epsilon;
+	constexpr double InSphereBound = 64.0 * Epsilon; // borne volontairement large pour notre forme du déterminant
+
+	void TwoSum(double a, double b, double& x, double& y)
+	{
+		x = a + b;
+		const double bv = x - a;
+		const double av = x - bv;
+		y = (a - av) + (b - bv);
+	}
+
+	void Split(double a, double& hi, double& lo)
+	{
+		const double c = Splitter * a;
+		hi = c - (c - a);
+		lo = a - hi;
+	}
+
+	void TwoProduct(double a, double b, double& x, double& y)
+	{
+		x = a * b;
+		double ahi, alo, bhi, blo;
+		Split(a, ahi, alo);
+		Split(b, bhi, blo);
+		y = alo * blo - (((x - ahi * bhi) - alo * bhi) - ahi * blo);
+	}
+
+	// E + b (Grow-Expansion, avec élimination des zéros)
+	void Grow(FExpansion& E, double b)
+	{
+		double Q = b;
+		int32 Out = 0;
+		for (int32 i = 0; i < E.Num(); ++i)
+		{
+			double Sum, Err;
+			TwoSum(Q, E[i], Sum, Err);
+			Q = Sum;
+			if (Err != 0.0) E[Out++] = Err;
+		}
+		E.SetNum(Out, EAllowShrinking::No);
+		if (Q != 0.0) E.Add(Q);
+	}
+
+	FExpansion Diff(double a, double b)
+	{
+		double x, y;
+		TwoSum(a, -b, x, y);
+		FExpansion E;
+		if (y != 0.0) E.Add(y);
+		if (x != 0.0) E.Add(x);
+		return E;
+	}
+
+	FExpansion Add(const FExpansion& E, const FExpansion& F)
+	{
+		FExpansion R = E;
+		for (double f : F) Grow(R, f);
+		return R;
+	}
+
+	FExpansion Sub(const FExpansion& E, const FExpansion& F)
+	{
+		FExpansion R = E;
+		for (double f : F) Grow(R, -f);
+		return R;
+	}
+
+	FExpansion Mul(const FExpansion& E, const FExpansion& F)
+	{
+		FExpansion R;
+		for (double f : F)
+		{
+			for (double e : E)
+			{
+				double x, y;
+				TwoProduct(e, f, x, y);
+				if (y != 0.0) Grow(R, y);
+				if (x != 0.0) Grow(R, x);
+			}
+		}
+		return R;
+	}
+
+	int32 SignOf(const FExpansion& E)
+	{
+		return E.Num() == 0 ? 0 : (E.Last() > 0.0 ? 1 : -1);
+	}
+
+	FExpansion Det2(const FExpansion& a, const FExpansion& b, const FExpansion& c, const FExpansion& d)
+	{
+		return Sub(Mul(a, d), Mul(b, c));
+	}
+
+	FExpansion Det3(const FExpansion* p, const FExpansion* q, const FExpansion* r)
+	{
+		FExpansion R = Mul(p[0], Det2(q[1], q[2], r[1], r[2]));
+		R = Sub(R, Mul(p[1], Det2(q[0], q[2], r[0], r[2])));
+		return Add(R, Mul(p[2], Det2(q[0], q[1], r[0], r[1])));
+	}
+
+	FExpansion Lift(const FExpansion* p)
+	{
+		return Add(Add(Mul(p[0], p[0]), Mul(p[1], p[1])), Mul(p[2], p[2]));
+	}
+
+	int32 Sign(double V) { return (V > 0.0) - (V < 0.0); }
+}
+}
+
+int32 FDungeonExactPredicates::Orient2DImpl(double ax, double ay, double bx, double by, double cx, double cy)
+{
+	using namespace DungeonExact;
+
+	const double Left  = (ax - cx) * (by - cy);
+	const double Right = (ay - cy) * (bx - cx);
+	const double Det = Left - Right;
+	if (FMath::Abs(Det) > Orient2DBound * (FMath::Abs(Left) + FMath::Abs(Right))) return Sign(Det);
+
+	return SignOf(Det2(Diff(ax, cx), Diff(bx, cx), Diff(ay, cy), Diff(by, cy)));
+}
+
+int32 FDungeonExactPredicates::InCircleImpl(double ax, double ay, double bx, double by, double cx, double cy, double dx, double dy)
+{
+	using namespace DungeonExact;
+
+	const double adx = ax - dx, ady = ay - dy, bdx = bx - dx, bdy = by - dy, cdx = cx - dx, cdy = cy - dy;
+	const double alift = adx * adx + ady * ady, blift = bdx * bdx + bdy * bdy, clift = cdx * cdx + cdy * cdy;
+	const double Det = alift * (bdx * cdy - cdx * bdy) + blift * (cdx * ady - adx * cdy) + clift * (adx * bdy - bdx * ady);
+	const double Permanent = (FMath::Abs(bdx * cdy) + FMath::Abs(cdx * bdy)) * alift
+	                       + (FMath::Abs(cdx * ady) + FMath::Abs(adx * cdy)) * blift
+	                       + (FMath::Abs(adx * bdy) + FMath::Abs(bdx * ady)) * clift;
+	if (FMath::Abs(Det) > InCircleBound * Permanent) return Sign(Det);
+
+	const FExpansion A[3] = { Diff(ax, dx), Diff(ay, dy), FExpansion() };
+	const FExpansion B[3] = { Diff(bx, dx), Diff(by, dy), FExpansion() };
+	const FExpansion C[3] = { Diff(cx, dx), Diff(cy, dy), FExpansion() };
+	const FExpansion AL = Lift(A), BL = Lift(B), CL = Lift(C);
+
+	FExpansion R = Mul(AL, Det2(B[0], B[1], C[0], C[1]));
+	R = Add(R, Mul(BL, Det2(C[0], C[1], A[0], A[1])));
+	R = Add(R, Mul(CL, Det2(A[0], A[1], B[0], B[1])));
+	return SignOf(R);
+}
+
+int32 FDungeonExactPredicates::Orient3DImpl(const double* a, const double* b, const double* c, const double* d)
+{
+	using namespace DungeonExact;
+
+	const double bx = b[0] - a[0], by = b[1] - a[1], bz = b[2] - a[2];
+	const double cx = c[0] - a[0], cy = c[1] - a[1], cz = c[2] - a[2];
+	const double dx = d[0] - a[0], dy = d[1] - a[1], dz = d[2] - a[2];
+	const double Det = bx * (cy * dz - cz * dy) - by * (cx * dz - cz * dx) + bz * (cx * dy - cy * dx);
+	const double Permanent = (FMath::Abs(cy * dz) + FMath::Abs(cz * dy)) * FMath::Abs(bx)
+	                       + (FMath::Abs(cx * dz) + FMath::Abs(cz * dx)) * FMath::Abs(by)
+	                       + (FMath::Abs(cx * dy) + FMath::Abs(cy * dx)) * FMath::Abs(bz);
+	if (FMath::Abs(Det) > Orient3DBound * Permanent) return Sign(Det);
+
+	const FExpansion B[3] = { Diff(b[0], a[0]), Diff(b[1], a[1]), Diff(b[2], a[2]) };
+	const FExpansion C[3] = { Diff(c[0], a[0]), Diff(c[1], a[1]), Diff(c[2], a[2]) };
+	const FExpansion D[3] = { Diff(d[0], a[0]), Diff(d[1], a[1]), Diff(d[2], a[2]) };
+	return SignOf(Det3(B, C, D));
+}
+
+int32 FDungeonExactPredicates::InSphereImpl(const double* a, const double* b, const double* c, const double* d, const double* e)
+{
+	using namespace DungeonExact;
+
+	double ae[3], be[3], ce[3], de[3];
+	for (int32 i = 0; i < 3; ++i) { ae[i] = a[i] - e[i]; be[i] = b[i] - e[i]; ce[i] = c[i] - e[i]; de[i] = d[i] - e[i]; }
+
+	auto Det3d = [](const double* p, const double* q, const double* r)
+	{
+		return p[0] * (q[1] * r[2] - q[2] * r[1]) - p[1] * (q[0] * r[2] - q[2] * r[0]) + p[2] * (q[0] * r[1] - q[1] * r[0]);
+	};
+	auto Perm3d = [](const double* p, const double* q, const double* r)
+	{
+		return FMath::Abs(p[0]) * (FMath::Abs(q[1] * r[2]) + FMath::Abs(q[2] * r[1]))
+		     + FMath::Abs(p[1]) * (FMath::Abs(q[0] * r[2]) + FMath::Abs(q[2] * r[0]))
+		     + FMath::Abs(p[2]) * (FMath::Abs(q[0] * r[1]) + FMath::Abs(q[1] * r[0]));
+	};
+	auto Lift3d = [](const double* p) { return p[0] * p[0] + p[1] * p[1] + p[2] * p[2]; };
+
+	const double al = Lift3d(ae), bl = Lift3d(be), cl = Lift3d(ce), dl = Lift3d(de);
+	const double Det = al * Det3d(be, ce, de) - bl * Det3d(ae, ce, de) + cl * Det3d(ae, be, de) - dl * Det3d(ae, be, ce);
+	const double Permanent = al * Perm3d(be, ce, de) + bl * Perm3d(ae, ce, de) + cl * Perm3d(ae, be, de) + dl * Perm3d(ae, be, ce);
+	if (FMath::Abs(Det) > InSphereBound * Permanent) return Sign(Det);
+
+	FExpansion A[3], B[3], C[3], D[3];
+	for (int32 i = 0; i < 3; ++i)
+	{
+		A[i] = Diff(a[i], e[i]); B[i] = Diff(b[i], e[i]); C[i] = Diff(c[i], e[i]); D[i] = Diff(d[i], e[i]);
+	}
+	FExpansion R = Mul(Lift(A), Det3(B, C, D));
+	R = Sub(R, Mul(Lift(B), Det3(A, C, D)));
+	R = Add(R, Mul(Lift(C), Det3(A, B, D)));
+	R = Sub(R, Mul(Lift(D), Det3(A, B, C)));
+	return SignOf(R);
+}
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#pragma float_control(pop)
+#endif
@@ -0,0 +1,192 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include <type_traits>
+
+// ================= Prédicats =================
+// Les deux politiques renvoient le signe (-1, 0, 1) :
+//  Orient2D(a, b, c)        > 0 si abc tourne dans le sens anti-horaire
+//  InCircle(a, b, c, d)     > 0 si d est dans le cercle de abc (abc anti-horaire)
+//  Orient3D(a, b, c, d)     > 0 si det[b-a, c-a, d-a] > 0
+//  InSphere(a, b, c, d, e)  > 0 si e est dans la sphère de abcd (Orient3D(a, b, c, d) > 0)
+
+// Évaluation directe dans le type scalaire : rapide, mais le signe est faux près des cas dégénérés
+struct FDungeonFastPredicates
+{
+	template<typename T> static int32 Sign(T V) { return (V > T(0)) - (V < T(0)); }
+
+	template<typename T>
+	static int32 Orient2D(T ax, T ay, T bx, T by, T cx, T cy)
+	{
+		return Sign((ax - cx) * (by - cy) - (ay - cy) * (bx - cx));
+	}
+
+	template<typename T>
+	static int32 InCircle(T ax, T ay, T bx, T by, T cx, T cy, T dx, T dy)
+	{
+		const T adx = ax - dx, ady = ay - dy, bdx = bx - dx, bdy = by - dy, cdx = cx - dx, cdy = cy - dy;
+		const T alift = adx * adx + ady * ady, blift = bdx * bdx + bdy * bdy, clift = cdx * cdx + cdy * cdy;
+		return Sign(alift * (bdx * cdy - cdx * bdy) + blift * (cdx * ady - adx * cdy) + clift * (adx * bdy - bdx * ady));
+	}
+
+	template<typename T>
+	static int32 Orient3D(const T* a, const T* b, const T* c, const T* d)
+	{
+		const T bx = b[0] - a[0], by = b[1] - a[1], bz = b[2] - a[2];
+		const T cx = c[0] - a[0], cy = c[1] - a[1], cz = c[2] - a[2];
+		const T dx = d[0] - a[0], dy = d[1] - a[1], dz = d[2] - a[2];
+		return Sign(bx * (cy * dz - cz * dy) - by * (cx * dz - cz * dx) + bz * (cx * dy - cy * dx));
+	}
+
+	template<typename T>
+	static int32 InSphere(const T* a, const T* b, const T* c, const T* d, const T* e)
+	{
+		T ae[3], be[3], ce[3], de[3];
+		for (int32 i = 0; i < 3; ++i) { ae[i] = a[i] - e[i]; be[i] = b[i] - e[i]; ce[i] = c[i] - e[i]; de[i] = d[i] - e[i]; }
+		auto Det3 = [](const T* p, const T* q, const T* r)
+		{
+			return p[0] * (q[1] * r[2] - q[2] * r[1]) - p[1] * (q[0] * r[2] - q[2] * r[0]) + p[2] * (q[0] * r[1] - q[1] * r[0]);
+		};
+		auto Lift = [](const T* p) { return p[0] * p[0] + p[1] * p[1] + p[2] * p[2]; };
+		return Sign(Lift(ae) * Det3(be, ce, de) - Lift(be) * Det3(ae, ce, de) + Lift(ce) * Det3(ae, be, de) - Lift(de) * Det3(ae, be, ce));
+	}
+};
+
+// Filtre en double (bornes d'erreur à la Shewchuk) puis, seulement si le signe est incertain,
+// évaluation exacte par arithmétique d'expansions. Les entrées float sont converties sans perte.
+struct TRIANGULATION_BASED_API FDungeonExactPredicates
+{
+	template<typename T>
+	static int32 Orient2D(T ax, T ay, T bx, T by, T cx, T cy)
+	{
+		return Orient2DImpl(double(ax), double(ay), double(bx), double(by), double(cx), double(cy));
+	}
+
+	template<typename T>
+	static int32 InCircle(T ax, T ay, T bx, T by, T cx, T cy, T dx, T dy)
+	{
+		return InCircleImpl(double(ax), double(ay), double(bx), double(by), double(cx), double(cy), double(dx), double(dy));
+	}
+
+	template<typename T>
+	static int32 Orient3D(const T* a, const T* b, const T* c, const T* d)
+	{
+		const double A[3] = { double(a[0]), double(a[1]), double(a[2]) }, B[3] = { double(b[0]), double(b[1]), double(b[2]) };
+		const double C[3] = { double(c[0]), double(c[1]), double(c[2]) }, D[3] = { double(d[0]), double(d[1]), double(d[2]) };
+		return Orient3DImpl(A, B, C, D);
+	}
+
+	template<typename T>
+	static int32 InSphere(const T* a, const T* b, const T* c, const T* d, const T* e)
+	{
+		const double A[3] = { double(a[0]), double(a[1]), double(a[2]) }, B[3] = { double(b[0]), double(b[1]), double(b[2]) };
+		const double C[3] = { double(c[0]), double(c[1]), double(c[2]) }, D[3] = { double(d[0]), double(d[1]), double(d[2]) };
+		const double E[3] = { double(e[0]), double(e[1]), double(e[2]) };
+		return InSphereImpl(A, B, C, D, E);
+	}
+
+	static int32 Orient2DImpl(double ax, double ay, double bx, double by, double cx, double cy);
+	static int32 InCircleImpl(double ax, double ay, double bx, double by, double cx, double cy, double dx, double dy);
+	static int32 Orient3DImpl(const double* a, const double* b, const double* c, const double* d);
+	static int32 InSphereImpl(const double* a, const double* b, const double* c, const double* d, const double* e);
+};
+
+// ================= Noyau géométrique =================
+// Paramétré à la compilation sur le scalaire, la dimension et la politique de prédicats :
+// chaque instanciation est spécialisée et inlinée dans les boucles qui l'utilisent.
+template<typename Scalar, int32 Dim, typename Predicates>
+struct TDungeonKernel
+{
+	static_assert(Dim == 2 || Dim == 3, "TDungeonKernel only supports 2D and 3D");
+
+	using FScalar = Scalar;
+	using FVec = std::conditional_t<Dim == 2, UE::Math::TVector2<Scalar>, UE::Math::TVector<Scalar>>;
+	static constexpr int32 Dimension = Dim;
+
+	// Liang–Barsky : intervalle [OutU0, OutU1] du segment P0->P1 à l'intérieur de la boîte Center +/- Half
+	static bool ClipSegment(const FVec& P0, const FVec& P1, const FVec& Center, const FVec& Half, Scalar& OutU0, Scalar& OutU1)
+	{
+		Scalar u0 = 0, u1 = 1;
+		for (int32 Axis = 0; Axis < Dim; ++Axis)
+		{
+			const Scalar d  = P1[Axis] - P0[Axis];
+			const Scalar Lo = P0[Axis] - (Center[Axis] - Half[Axis]);
+			const Scalar Hi = (Center[Axis] + Half[Axis]) - P0[Axis];
+			const Scalar p[2] = { -d, d };
+			const Scalar q[2] = { Lo, Hi };
+			for (int32 s = 0; s < 2; ++s)
+			{
+				if (FMath::IsNearlyZero(p[s]))
+				{
+					if (q[s] < 0) return false;
+				}
+				else
+				{
+					const Scalar t = q[s] / p[s];
+					if (p[s] < 0) { if (t > u1) return false; if (t > u0) u0 = t; }
+					else          { if (t < u0) return false; if (t < u1) u1 = t; }
+				}
+			}
+		}
+		OutU0 = u0; OutU1 = u1;
+		return true;
+	}
+
+	static bool SegmentIntersectsBox(const FVec& P0, const FVec& P1, const FVec& Center, const FVec& Half)
+	{
+		Scalar u0, u1;
+		return ClipSegment(P0, P1, Center, Half, u0, u1);
+	}
+
+	// Point où le segment Start->Toward sort de la boîte (Start s'il ne la traverse pas)
+	static FVec ExitPoint(const FVec& Start, const FVec& Toward, const FVec& Center, const FVec& Half)
+	{
+		Scalar u0, u1;
+		if (!ClipSegment(Start, Toward, Center, Half, u0, u1)) return Start;
+		return Start + (Toward - Start) * u1;
+	}
+
+	static int32 Orient(const FVec& A, const FVec& B, const FVec& C) requires (Dim == 2)
+	{
+		return Predicates::Orient2D(A.X, A.Y, B.X, B.Y, C.X, C.Y);
+	}
+
+	static int32 InCircle(const FVec& A, const FVec& B, const FVec& C, const FVec& D) requires (Dim == 2)
+	{
+		return Predicates::InCircle(A.X, A.Y, B.X, B.Y, C.X, C.Y, D.X, D.Y);
+	}
+
+	// P strictement dans le cercle circonscrit de ABC, quel que soit le sens du triangle ; faux s'il est plat
+	static bool InCircumcircle(const FVec& P, const FVec& A, const FVec& B, const FVec& C) requires (Dim == 2)
+	{
+		const int32 O = Orient(A, B, C);
+		return O != 0 && InCircle(A, B, C, P) * O > 0;
+	}
+
+	static int32 Orient(const FVec& A, const FVec& B, const FVec& C, const FVec& D) requires (Dim == 3)
+	{
+		const Scalar a[3] = { A.X, A.Y, A.Z }, b[3] = { B.X, B.Y, B.Z }, c[3] = { C.X, C.Y, C.Z }, d[3] = { D.X, D.Y, D.Z };
+		return Predicates::Orient3D(a, b, c, d);
+	}
+
+	static int32 InSphere(const FVec& A, const FVec& B, const FVec& C, const FVec& D, const FVec& E) requires (Dim == 3)
+	{
+		const Scalar a[3] = { A.X, A.Y, A.Z }, b[3] = { B.X, B.Y, B.Z }, c[3] = { C.X, C.Y, C.Z };
+		const Scalar d[3] = { D.X, D.Y, D.Z }, e[3] = { E.X, E.Y, E.Z };
+		return Predicates::InSphere(a, b, c, d, e);
+	}
+};
+
+// Noyaux utilisés par la génération : le graphe en exact (les centres quantifiés sont souvent cocycliques)
+using FDungeonKernel2D = TDungeonKernel<double, 2, FDungeonExactPredicates>;
+using FDungeonKernel3D = TDungeonKernel<double, 3, FDungeonExactPredicates>;
+
+// Instanciations explicites (DungeonGeometryKernel.cpp) : les autres unités de compilation ne les réinstancient pas
+extern template struct TDungeonKernel<float,  2, FDungeonFastPredicates>;
+extern template struct TDungeonKernel<float,  3, FDungeonFastPredicates>;
+extern template struct TDungeonKernel<double, 2, FDungeonFastPredicates>;
+extern template struct TDungeonKernel<double, 3, FDungeonFastPredicates>;
+extern template struct TDungeonKernel<float,  2, FDungeonExactPredicates>;
+extern template struct TDungeonKernel<float,  3, FDungeonExactPredicates>;
+extern template struct TDungeonKernel<double, 2, FDungeonExactPredicates>;
+extern template struct TDungeonKernel<double, 3, FDungeonExactPredicates>;
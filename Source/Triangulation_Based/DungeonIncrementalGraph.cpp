@@ -0,0 +1,475 @@
+#include "DungeonIncrementalGraph.h"
+#include "DungeonGeometryKernel.h"
+#include "Algo/Sort.h"
+
+namespace
+{
+	uint64 EdgeKey(int32 A, int32 B)
+	{
+		return (static_cast<uint64>(FMath::Min(A, B)) << 32) | static_cast<uint32>(FMath::Max(A, B));
+	}
+}
+
+void FDungeonIncrementalGraph::Reset(const TArray<FVector2D>& Points, double DomainRadius, TArray<int32>& OutIds)
+{
+	Pts.Reset();
+	VertexTri.Reset();
+	Tris.Reset();
+	FreeTris.Reset();
+	Mark.Reset();
+	Forest.Reset();
+	VertexNode.Reset();
+	TreeEdges.Reset();
+	TreeAdj.Reset();
+	NumAlive = 0;
+
+	double R = FMath::Max(DomainRadius, 1.0);
+	for (const FVector2D& P : Points) R = FMath::Max(R, P.GetAbsMax());
+	Domain = 4.0 * R;
+
+	// Super-triangle loin devant le domaine : ses sommets ne déforment pas les cercles des triangles du bord
+	const double S = 64.0 * R;
+	Pts.Add(FVector2D(-3.0 * S, -3.0 * S));
+	Pts.Add(FVector2D( 3.0 * S, -3.0 * S));
+	Pts.Add(FVector2D( 0.0,      3.0 * S));
+	for (int32 i = 0; i < NumSuper; ++i)
+	{
+		VertexTri.Add(0);
+		VertexNode.Add(INDEX_NONE);
+		TreeAdj.AddDefaulted();
+	}
+	AllocTri(0, 1, 2);
+	Last = 0;
+
+	FDelta Delta;
+	OutIds.Reset(Points.Num());
+	for (const FVector2D& P : Points) OutIds.Add(Insert(P, Delta));
+}
+
+bool FDungeonIncrementalGraph::IsValidVertex(int32 Vertex) const
+{
+	return IsReal(Vertex) && VertexTri.IsValidIndex(Vertex) && VertexTri[Vertex] != INDEX_NONE;
+}
+
+int32 FDungeonIncrementalGraph::AllocTri(int32 A, int32 B, int32 C)
+{
+	int32 t;
+	if (FreeTris.Num() > 0) t = FreeTris.Pop(EAllowShrinking::No);
+	else { t = Tris.AddUninitialized(); Mark.Add(0); }
+
+	FTri& T = Tris[t];
+	T.V[0] = A; T.V[1] = B; T.V[2] = C;
+	T.N[0] = T.N[1] = T.N[2] = INDEX_NONE;
+	return t;
+}
+
+int32 FDungeonIncrementalGraph::SlotOf(int32 T, int32 V) const
+{
+	const FTri& Tri = Tris[T];
+	return Tri.V[0] == V ? 0 : (Tri.V[1] == V ? 1 : 2);
+}
+
+int32 FDungeonIncrementalGraph::SlotAcross(int32 T, int32 A, int32 B) const
+{
+	const FTri& Tri = Tris[T];
+	return (Tri.V[0] != A && Tri.V[0] != B) ? 0 : ((Tri.V[1] != A && Tri.V[1] != B) ? 1 : 2);
+}
+
+int32 FDungeonIncrementalGraph::Locate(const FVector2D& P) const
+{
+	// Marche de visibilité depuis le dernier triangle créé
+	int32 t = Last;
+	const int32 MaxSteps = Tris.Num() + 16;
+	for (int32 Step = 0; Step < MaxSteps; ++Step)
+	{
+		bool bMoved = false;
+		for (int32 k = 0; k < 3; ++k)
+		{
+			const int32 f = (k + Step) % 3;
+			const FTri& T = Tris[t];
+			if (T.N[f] != INDEX_NONE && FDungeonKernel2D::Orient(Pts[T.V[(f + 1) % 3]], Pts[T.V[(f + 2) % 3]], P) < 0)
+			{
+				t = T.N[f];
+				bMoved = true;
+				break;
+			}
+		}
+		if (!bMoved) return t;
+	}
+
+	for (int32 i = 0; i < Tris.Num(); ++i)
+	{
+		const FTri& T = Tris[i];
+		if (T.V[0] == INDEX_NONE) continue;
+		if (FDungeonKernel2D::Orient(Pts[T.V[0]], Pts[T.V[1]], P) >= 0 &&
+		    FDungeonKernel2D::Orient(Pts[T.V[1]], Pts[T.V[2]], P) >= 0 &&
+		    FDungeonKernel2D::Orient(Pts[T.V[2]], Pts[T.V[0]], P) >= 0) return i;
+	}
+	return t;
+}
+
+void FDungeonIncrementalGraph::Stitch()
+{
+	// Recolle les nouveaux triangles entre eux et avec ceux restés autour du trou, par arête partagée
+	Link.Reset();
+	for (const FHoleEdge& H : Hole)
+		if (H.Outer != INDEX_NONE) Link.Add(EdgeKey(H.A, H.B), H.Outer * 4 + H.OuterSlot);
+
+	for (int32 nt : NewTris)
+	{
+		FTri& T = Tris[nt];
+		for (int32 j = 0; j < 3; ++j)
+		{
+			const uint64 Key = EdgeKey(T.V[(j + 1) % 3], T.V[(j + 2) % 3]);
+			if (const int32* Other = Link.Find(Key))
+			{
+				Tris[*Other >> 2].N[*Other & 3] = nt;
+				T.N[j] = *Other >> 2;
+				Link.Remove(Key);
+			}
+			else
+			{
+				Link.Add(Key, nt * 4 + j);
+			}
+		}
+		for (int32 v : T.V) VertexTri[v] = nt;
+	}
+	if (NewTris.Num() > 0) Last = NewTris.Last();
+}
+
+void FDungeonIncrementalGraph::Neighbors(int32 V, TArray<int32, TInlineAllocator<16>>& Out) const
+{
+	// Tour du sommet dans le sens trigonométrique : (V, a, b) puis le triangle qui partage (V, b)
+	Out.Reset();
+	const int32 Start = VertexTri[V];
+	int32 t = Start;
+	for (int32 Guard = 0; Guard < Tris.Num(); ++Guard)
+	{
+		const int32 i = SlotOf(t, V);
+		Out.Add(Tris[t].V[(i + 1) % 3]);
+		t = Tris[t].N[(i + 1) % 3];
+		if (t == Start || t == INDEX_NONE) break;
+	}
+}
+
+int32 FDungeonIncrementalGraph::Insert(const FVector2D& P, FDelta& Delta)
+{
+	Delta.Reset();
+	if (P.GetAbsMax() > Domain) return INDEX_NONE;
+
+	const int32 Start = Locate(P);
+	for (int32 v : Tris[Start].V)
+		if (Pts[v] == P) return INDEX_NONE;
+
+	const int32 Idx = Pts.Add(P);
+	VertexTri.Add(INDEX_NONE);
+	VertexNode.Add(Forest.AddVertexNode());
+	TreeAdj.AddDefaulted();
+	++NumAlive;
+
+	// Cavité : triangles connexes dont le cercle circonscrit contient P
+	++Epoch;
+	Cavity.Reset();
+	Stack.Reset();
+	Cavity.Add(Start); Stack.Add(Start); Mark[Start] = Epoch;
+	while (Stack.Num() > 0)
+	{
+		const int32 t = Stack.Pop(EAllowShrinking::No);
+		for (int32 f = 0; f < 3; ++f)
+		{
+			const int32 n = Tris[t].N[f];
+			if (n == INDEX_NONE || Mark[n] == Epoch) continue;
+			const FTri& Tn = Tris[n];
+			if (FDungeonKernel2D::InCircle(Pts[Tn.V[0]], Pts[Tn.V[1]], Pts[Tn.V[2]], P) > 0)
+			{
+				Mark[n] = Epoch;
+				Cavity.Add(n);
+				Stack.Add(n);
+			}
+		}
+	}
+
+	// Bord de la cavité ; une arête alignée avec P (cas cocyclique) fait entrer son voisin dans la cavité
+	bool bStarShaped = false;
+	while (!bStarShaped)
+	{
+		bStarShaped = true;
+		Hole.Reset();
+		for (int32 c = 0; c < Cavity.Num() && bStarShaped; ++c)
+		{
+			const int32 t = Cavity[c];
+			for (int32 f = 0; f < 3; ++f)
+			{
+				const int32 n = Tris[t].N[f];
+				if (n != INDEX_NONE && Mark[n] == Epoch) continue;
+
+				const int32 A = Tris[t].V[(f + 1) % 3];
+				const int32 B = Tris[t].V[(f + 2) % 3];
+				if (n != INDEX_NONE && FDungeonKernel2D::Orient(Pts[A], Pts[B], P) <= 0)
+				{
+					Mark[n] = Epoch;
+					Cavity.Add(n);
+					bStarShaped = false;
+					break;
+				}
+				Hole.Add({ A, B, n, n != INDEX_NONE ? SlotAcross(n, A, B) : INDEX_NONE });
+			}
+		}
+	}
+
+	for (int32 t : Cavity)
+	{
+		Tris[t].V[0] = INDEX_NONE;
+		FreeTris.Add(t);
+	}
+
+	NewTris.Reset();
+	TArray<int32, TInlineAllocator<16>> Ring;
+	for (const FHoleEdge& H : Hole)
+	{
+		NewTris.Add(AllocTri(Idx, H.A, H.B));
+		Ring.Add(H.A);
+	}
+	Stitch();
+	Delta.TouchedTriangles = Cavity.Num() + NewTris.Num();
+
+	RepairAfterInsert(Idx, Ring, Delta);
+	return Idx;
+}
+
+bool FDungeonIncrementalGraph::Remove(int32 Vertex, FDelta& Delta)
+{
+	Delta.Reset();
+	if (!IsValidVertex(Vertex)) return false;
+
+	// Étoile du sommet : anneau de voisins (sens trigonométrique) et triangles extérieurs à chaque arête de l'anneau
+	Hole.Reset();
+	Cavity.Reset();
+	const int32 Start = VertexTri[Vertex];
+	int32 t = Start;
+	for (int32 Guard = 0; Guard < Tris.Num(); ++Guard)
+	{
+		const int32 i = SlotOf(t, Vertex);
+		const FTri& T = Tris[t];
+		const int32 n = T.N[i];
+		const int32 A = T.V[(i + 1) % 3], B = T.V[(i + 2) % 3];
+		Hole.Add({ A, B, n, n != INDEX_NONE ? SlotAcross(n, A, B) : INDEX_NONE });
+		Cavity.Add(t);
+		t = T.N[(i + 1) % 3];
+		if (t == Start || t == INDEX_NONE) break;
+	}
+
+	// Le MST d'abord : les arêtes du sommet partent, leurs autres extrémités sont les racines des composantes à relier
+	TArray<int32, TInlineAllocator<8>> Roots;
+	for (int32 u : TreeAdj[Vertex]) Roots.Add(u);
+	for (int32 u : Roots) RemoveTreeEdge(FDGEdge(Vertex, u), Delta);
+
+	for (int32 c : Cavity)
+	{
+		Tris[c].V[0] = INDEX_NONE;
+		FreeTris.Add(c);
+	}
+
+	// Oreilles de Delaunay : convexe et sans autre sommet de l'anneau dans son cercle circonscrit
+	TArray<int32, TInlineAllocator<16>> Poly;
+	for (const FHoleEdge& H : Hole) Poly.Add(H.A);
+	NewTris.Reset();
+	while (Poly.Num() > 3)
+	{
+		const int32 n = Poly.Num();
+		int32 Ear = INDEX_NONE, Convex = INDEX_NONE;
+		for (int32 i = 0; i < n && Ear == INDEX_NONE; ++i)
+		{
+			const int32 a = Poly[(i + n - 1) % n], b = Poly[i], c = Poly[(i + 1) % n];
+			if (FDungeonKernel2D::Orient(Pts[a], Pts[b], Pts[c]) <= 0) continue;
+			if (Convex == INDEX_NONE) Convex = i;
+
+			bool bEmpty = true;
+			for (int32 k = 0; k < n && bEmpty; ++k)
+			{
+				const int32 x = Poly[k];
+				if (x == a || x == b || x == c) continue;
+				bEmpty = FDungeonKernel2D::InCircle(Pts[a], Pts[b], Pts[c], Pts[x]) <= 0;
+			}
+			if (bEmpty) Ear = i;
+		}
+		if (Ear == INDEX_NONE) Ear = (Convex != INDEX_NONE) ? Convex : 0;
+
+		NewTris.Add(AllocTri(Poly[(Ear + n - 1) % n], Poly[Ear], Poly[(Ear + 1) % n]));
+		Poly.RemoveAt(Ear, 1, EAllowShrinking::No);
+	}
+	if (Poly.Num() == 3) NewTris.Add(AllocTri(Poly[0], Poly[1], Poly[2]));
+
+	VertexTri[Vertex] = INDEX_NONE;
+	Stitch();
+	Forest.FreeNode(VertexNode[Vertex]);
+	VertexNode[Vertex] = INDEX_NONE;
+	--NumAlive;
+	Delta.TouchedTriangles = Cavity.Num() + NewTris.Num();
+
+	RepairAfterRemove(Roots, Delta);
+	return true;
+}
+
+void FDungeonIncrementalGraph::AddTreeEdge(const FDGEdge& E, FDelta& Delta)
+{
+	const int32 Node = Forest.AddEdgeNode(E, Weight(E));
+	Forest.Link(VertexNode[E.A], Node);
+	Forest.Link(Node, VertexNode[E.B]);
+	TreeEdges.Add(E, Node);
+	TreeAdj[E.A].Add(E.B);
+	TreeAdj[E.B].Add(E.A);
+	Delta.AddedEdges.Add(E);
+}
+
+void FDungeonIncrementalGraph::RemoveTreeEdge(const FDGEdge& E, FDelta& Delta)
+{
+	int32 Node = INDEX_NONE;
+	if (!TreeEdges.RemoveAndCopyValue(E, Node)) return;
+	Forest.Cut(VertexNode[E.A], Node);
+	Forest.Cut(Node, VertexNode[E.B]);
+	Forest.FreeNode(Node);
+	TreeAdj[E.A].RemoveSingleSwap(E.B, EAllowShrinking::No);
+	TreeAdj[E.B].RemoveSingleSwap(E.A, EAllowShrinking::No);
+	if (Delta.AddedEdges.RemoveSingleSwap(E, EAllowShrinking::No) == 0) Delta.RemovedEdges.Add(E);
+}
+
+void FDungeonIncrementalGraph::RepairAfterInsert(int32 V, const TArray<int32, TInlineAllocator<16>>& Ring, FDelta& Delta)
+{
+	// Le nouveau MST est inclus dans l'ancien plus les arêtes de V : chacune, de la plus légère à la plus lourde,
+	// relie deux arbres ou remplace l'arête la plus lourde du cycle qu'elle ferme
+	TArray<TPair<double, FDGEdge>, TInlineAllocator<16>> Candidates;
+	for (int32 u : Ring)
+	{
+		if (!IsReal(u)) continue;
+		const FDGEdge E(V, u);
+		Candidates.Emplace(Weight(E), E);
+	}
+	Algo::Sort(Candidates, [](const TPair<double, FDGEdge>& L, const TPair<double, FDGEdge>& R)
+	{
+		return FDungeonLinkCutForest::Heavier(R.Key, R.Value, L.Key, L.Value);
+	});
+
+	for (const TPair<double, FDGEdge>& C : Candidates)
+	{
+		const int32 NA = VertexNode[C.Value.A], NB = VertexNode[C.Value.B];
+		if (!Forest.Connected(NA, NB))
+		{
+			AddTreeEdge(C.Value, Delta);
+			continue;
+		}
+		const int32 M = Forest.PathMax(NA, NB);
+		if (M != INDEX_NONE && FDungeonLinkCutForest::Heavier(Forest.GetWeight(M), Forest.GetEdge(M), C.Key, C.Value))
+		{
+			RemoveTreeEdge(Forest.GetEdge(M), Delta);
+			AddTreeEdge(C.Value, Delta);
+		}
+	}
+}
+
+void FDungeonIncrementalGraph::RepairAfterRemove(const TArray<int32, TInlineAllocator<8>>& Roots, FDelta& Delta)
+{
+	const int32 NumComps = Roots.Num();
+	if (NumComps < 2) return;
+
+	// Les arêtes restantes du MST y restent ; il manque au plus NumComps - 1 arêtes entre les sous-arbres.
+	// Parcours des sous-arbres en parallèle, pas à pas : tous sauf le plus gros sont énumérés en entier,
+	// et toute arête qui les relie a une extrémité dans l'un d'eux
+	TMap<int32, int32> Comp;
+	TArray<TArray<int32>, TInlineAllocator<8>> Queue;
+	TArray<int32, TInlineAllocator<8>> Head;
+	Queue.SetNum(NumComps);
+	Head.Init(0, NumComps);
+	for (int32 c = 0; c < NumComps; ++c)
+	{
+		Comp.Add(Roots[c], c);
+		Queue[c].Add(Roots[c]);
+	}
+
+	int32 Open = NumComps;
+	int32 Big = INDEX_NONE;
+	while (Open > 1)
+	{
+		for (int32 c = 0; c < NumComps && Open > 1; ++c)
+		{
+			if (Head[c] == INDEX_NONE) continue;
+			if (Head[c] == Queue[c].Num())
+			{
+				Head[c] = INDEX_NONE;
+				--Open;
+				continue;
+			}
+			const int32 x = Queue[c][Head[c]++];
+			for (int32 y : TreeAdj[x])
+			{
+				if (Comp.Contains(y)) continue;
+				Comp.Add(y, c);
+				Queue[c].Add(y);
+			}
+		}
+	}
+	for (int32 c = 0; c < NumComps; ++c)
+		if (Head[c] != INDEX_NONE) Big = c;
+
+	TArray<TPair<double, FDGEdge>> Candidates;
+	TArray<int32, TInlineAllocator<16>> Around;
+	for (int32 c = 0; c < NumComps; ++c)
+	{
+		if (c == Big) continue;
+		for (int32 x : Queue[c])
+		{
+			Neighbors(x, Around);
+			for (int32 y : Around)
+			{
+				if (!IsReal(y)) continue;
+				const int32* Cy = Comp.Find(y);
+				const int32 CompY = Cy ? *Cy : Big;
+				if (CompY == c) continue;
+				if (CompY != Big && y < x) continue; // vue depuis l'autre petit sous-arbre
+				const FDGEdge E(x, y);
+				Candidates.Emplace(Weight(E), E);
+			}
+		}
+	}
+	Algo::Sort(Candidates, [](const TPair<double, FDGEdge>& L, const TPair<double, FDGEdge>& R)
+	{
+		return FDungeonLinkCutForest::Heavier(R.Key, R.Value, L.Key, L.Value);
+	});
+
+	// Kruskal sur les sous-arbres contractés
+	TArray<int32, TInlineAllocator<8>> Parent;
+	for (int32 c = 0; c < NumComps; ++c) Parent.Add(c);
+	auto Find = [&Parent](int32 X)
+	{
+		while (Parent[X] != X) X = Parent[X] = Parent[Parent[X]];
+		return X;
+	};
+
+	int32 Joined = 0;
+	for (const TPair<double, FDGEdge>& C : Candidates)
+	{
+		const int32* CA = Comp.Find(C.Value.A);
+		const int32* CB = Comp.Find(C.Value.B);
+		const int32 RA = Find(CA ? *CA : Big);
+		const int32 RB = Find(CB ? *CB : Big);
+		if (RA == RB) continue;
+		Parent[RA] = RB;
+		AddTreeEdge(C.Value, Delta);
+		if (++Joined == NumComps - 1) break;
+	}
+}
+
+void FDungeonIncrementalGraph::GetTriangles(TArray<FDGTriangle>& Out) const
+{
+	Out.Reset();
+	for (const FTri& T : Tris)
+	{
+		if (T.V[0] == INDEX_NONE) continue;
+		if (IsReal(T.V[0]) && IsReal(T.V[1]) && IsReal(T.V[2])) Out.Emplace(T.V[0], T.V[1], T.V[2]);
+	}
+}
+
+void FDungeonIncrementalGraph::GetMSTEdges(TArray<FDGEdge>& Out) const
+{
+	TreeEdges.GenerateKeyArray(Out);
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DungeonTypes.h"
+#include "DungeonLinkCutForest.h"
+
+// Delaunay 2D et MST euclidien des centres de main rooms, tenus à jour point par point en cours de partie.
+// Insertion : cavité de Bowyer–Watson autour du point ; suppression : le trou laissé par l'étoile du sommet
+// est re-triangulé par oreilles de Delaunay. Le MST est réparé sur une forêt link-cut. Une insertion coûte
+// la cavité plus O(log n) par arête candidate ; une suppression parcourt tous les sous-arbres du MST laissés
+// par le sommet sauf le plus gros, soit O(n) au pire (sommet très connecté). Aucun UObject.
+struct TRIANGULATION_BASED_API FDungeonIncrementalGraph
+{
+	// Arêtes du MST modifiées par une opération, en ids de sommets
+	struct FDelta
+	{
+		TArray<FDGEdge> RemovedEdges;
+		TArray<FDGEdge> AddedEdges;
+		int32 TouchedTriangles = 0;
+
+		void Reset() { RemovedEdges.Reset(); AddedEdges.Reset(); TouchedTriangles = 0; }
+	};
+
+	// Reconstruction complète. Les ids sont stables et croissent dans l'ordre d'insertion (jamais réutilisés) :
+	// OutIds[i] est l'id de Points[i], INDEX_NONE pour un doublon. Insert refuse tout point hors de DomainRadius.
+	void Reset(const TArray<FVector2D>& Points, double DomainRadius, TArray<int32>& OutIds);
+
+	// Id du nouveau sommet ; INDEX_NONE hors du domaine ou sur un sommet existant (rien n'est modifié)
+	int32 Insert(const FVector2D& Point, FDelta& OutDelta);
+	bool Remove(int32 Vertex, FDelta& OutDelta);
+
+	bool IsValidVertex(int32 Vertex) const;
+	int32 NumVertices() const { return NumAlive; }
+	void GetTriangles(TArray<FDGTriangle>& Out) const; // triangles entre vrais sommets, en ids
+	void GetMSTEdges(TArray<FDGEdge>& Out) const;
+
+private:
+	static constexpr int32 NumSuper = 3; // ids 0..2 : super-triangle
+
+	struct FTri
+	{
+		int32 V[3]; // sens trigonométrique
+		int32 N[3]; // N[i] : voisin à travers l'arête opposée à V[i]
+	};
+
+	// Arête du bord d'un trou, avec le triangle qui reste de l'autre côté
+	struct FHoleEdge
+	{
+		int32 A, B;
+		int32 Outer;
+		int32 OuterSlot;
+	};
+
+	TArray<FVector2D> Pts;
+	TArray<int32> VertexTri; // un triangle incident, INDEX_NONE pour un sommet supprimé
+	TArray<FTri> Tris;
+	TArray<int32> FreeTris;
+	double Domain = 0.0;
+	int32 Last = 0;
+	int32 NumAlive = 0;
+
+	FDungeonLinkCutForest Forest;
+	TArray<int32> VertexNode;          // noeud de chaque sommet dans la forêt
+	TMap<FDGEdge, int32> TreeEdges;    // arête du MST -> son noeud dans la forêt
+	TArray<TArray<int32, TInlineAllocator<6>>> TreeAdj;
+
+	// Tampons réutilisés d'une opération à l'autre
+	TArray<int32> Mark;
+	int32 Epoch = 0;
+	TArray<int32> Cavity;
+	TArray<int32> Stack;
+	TArray<FHoleEdge> Hole;
+	TArray<int32> NewTris;
+	TMap<uint64, int32> Link;
+
+	bool IsReal(int32 V) const { return V >= NumSuper; }
+	double Weight(const FDGEdge& E) const { return FVector2D::DistSquared(Pts[E.A], Pts[E.B]); }
+
+	int32 AllocTri(int32 A, int32 B, int32 C);
+	int32 SlotOf(int32 T, int32 V) const;
+	int32 SlotAcross(int32 T, int32 A, int32 B) const; // sommet de T opposé à l'arête AB
+	int32 Locate(const FVector2D& P) const;
+	void Stitch();
+	void Neighbors(int32 V, TArray<int32, TInlineAllocator<16>>& Out) const;
+
+	void AddTreeEdge(const FDGEdge& E, FDelta& Delta);
+	void RemoveTreeEdge(const FDGEdge& E, FDelta& Delta);
+	void RepairAfterInsert(int32 V, const TArray<int32, TInlineAllocator<16>>& Ring, FDelta& Delta);
+	void RepairAfterRemove(const TArray<int32, TInlineAllocator<8>>& Roots, FDelta& Delta);
+};
@@ -0,0 +1,180 @@
+#include "DungeonKernelBenchmarkCommandlet.h"
+#include "DungeonGenerator.h"
+#include "DungeonPipeline.h"
+#include "DungeonTetrahedralizer.h"
+#include "Triangulation_Based.h"
+
+namespace
+{
+	// Meilleur temps sur N itérations : le minimum est moins bruité que la moyenne sur une machine chargée
+	template<typename FuncType>
+	double BestMs(int32 Iterations, FuncType&& Func)
+	{
+		double Best = TNumericLimits<double>::Max();
+		for (int32 i = 0; i < Iterations; ++i)
+		{
+			const double T0 = FPlatformTime::Seconds();
+			Func();
+			Best = FMath::Min(Best, (FPlatformTime::Seconds() - T0) * 1000.0);
+		}
+		return Best;
+	}
+
+	// Points quantifiés sur une grille comme les centres de rooms : beaucoup de cas cocycliques
+	template<typename Kernel>
+	void MakeGridPoints(int32 Num, int32 Seed, TArray<typename Kernel::FVec>& Out)
+	{
+		using FVec = typename Kernel::FVec;
+		FRandomStream Rng(Seed);
+		const int32 Cells = FMath::Max(4, FMath::CeilToInt(FMath::Sqrt(static_cast<float>(Num)) * 2.f));
+		Out.Reset(Num);
+		for (int32 i = 0; i < Num; ++i)
+		{
+			if constexpr (Kernel::Dimension == 2) Out.Add(FVec(Rng.RandRange(0, Cells), Rng.RandRange(0, Cells)));
+			else Out.Add(FVec(Rng.RandRange(0, Cells), Rng.RandRange(0, Cells), Rng.RandRange(0, 3)));
+		}
+	}
+
+	template<typename Kernel>
+	void BenchDelaunay(const TCHAR* Name, int32 Num, int32 Seed, int32 Iterations)
+	{
+		TArray<typename Kernel::FVec> Points;
+		MakeGridPoints<Kernel>(Num, Seed, Points);
+		TArray<FDGTriangle> Tris;
+		const double Ms = BestMs(Iterations, [&] { FDungeonPipeline::BuildDelaunay<Kernel>(Points, Tris); });
+		UE_LOG(LogDungeon, Display, TEXT("  %-28s %9.3f ms  %6d triangles"), Name, Ms, Tris.Num());
+	}
+
+	template<typename Kernel>
+	void BenchTetrahedralize(const TCHAR* Name, int32 Num, int32 Seed, int32 Iterations)
+	{
+		TArray<FVector> Points;
+		MakeGridPoints<FDungeonKernel3D>(Num, Seed, Points);
+		TArray<FDGTetra> Tets;
+		TSet<FDGEdge> Edges;
+		const double Ms = BestMs(Iterations, [&] { FDungeonTetrahedralizer::Build<Kernel>(Points, Tets, Edges); });
+		UE_LOG(LogDungeon, Display, TEXT("  %-28s %9.3f ms  %6d tetrahedra, %d edges"), Name, Ms, Tets.Num(), Edges.Num());
+	}
+
+	template<typename Kernel>
+	void BenchClip(const TCHAR* Name, int32 Num, int32 Seed, int32 Iterations)
+	{
+		using FVec = typename Kernel::FVec;
+		TArray<FVec> Points, Boxes;
+		MakeGridPoints<Kernel>(Num, Seed, Points);
+		MakeGridPoints<Kernel>(64, Seed + 1, Boxes);
+		const FVec Half(2.5f);
+
+		// Les hits sont accumulés et loggés : la boucle ne peut pas être éliminée par l'optimiseur
+		int64 Hits = 0;
+		const double Ms = BestMs(Iterations, [&]
+		{
+			Hits = 0;
+			for (int32 i = 1; i < Points.Num(); ++i)
+				for (const FVec& C : Boxes)
+					Hits += Kernel::SegmentIntersectsBox(Points[i - 1], Points[i], C, Half);
+		});
+		const double Tests = static_cast<double>(Points.Num() - 1) * Boxes.Num();
+		UE_LOG(LogDungeon, Display, TEXT("  %-28s %9.3f ms  %6.1f Mtests/s (%lld hits)"),
+			Name, Ms, Ms > 0.0 ? Tests / (Ms * 1000.0) : 0.0, Hits);
+	}
+
+	template<EDungeonCorridorStyle Style>
+	void BenchCorridors(const TCHAR* Name, const FDungeonGenParams& P, const FDungeonLayout& Source, int32 Iterations)
+	{
+		FDungeonLayout Layout = Source;
+		const double Ms = BestMs(Iterations, [&] { FDungeonPipeline::BuildCorridors<Style>(P, Layout); });
+		UE_LOG(LogDungeon, Display, TEXT("  %-28s %9.3f ms  %6d segments"), Name, Ms, Layout.Corridors.Num());
+	}
+
+	double BenchPipeline(const TCHAR* Name, const FDungeonGenParams& P, int32 Seed, int32 Iterations)
+	{
+		FDungeonLayout Layout;
+		FDungeonGenStats Stats;
+		const double Ms = BestMs(Iterations, [&] { FDungeonPipeline::Generate(P, Seed, Layout, &Stats); });
+		UE_LOG(LogDungeon, Display, TEXT("  %-28s %9.3f ms  %6d rooms, %d MST edges, %d segments (relax %.2f ms)"),
+			Name, Ms, Layout.Rooms.Num(), Layout.MSTEdges.Num(), Layout.Corridors.Num(), Stats.RelaxMs);
+		return Ms;
+	}
+}
+
+UDungeonKernelBenchmarkCommandlet::UDungeonKernelBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 UDungeonKernelBenchmarkCommandlet::Main(const FString& Params)
+{
+	int32 NumPoints = 2000;
+	int32 Iterations = 20;
+	int32 Seed = 1;
+	int32 NumRooms = 4000;
+	int32 NumClusters = 16;
+	FParse::Value(*Params, TEXT("Points="), NumPoints);
+	FParse::Value(*Params, TEXT("Iterations="), Iterations);
+	FParse::Value(*Params, TEXT("Seed="), Seed);
+	FParse::Value(*Params, TEXT("Rooms="), NumRooms);
+	FParse::Value(*Params, TEXT("Clusters="), NumClusters);
+	NumPoints = FMath::Max(4, NumPoints);
+	Iterations = FMath::Max(1, Iterations);
+	NumRooms = FMath::Max(1, NumRooms);
+	NumClusters = FMath::Max(2, NumClusters);
+
+	using FKernel2fFast  = TDungeonKernel<float,  2, FDungeonFastPredicates>;
+	using FKernel2dFast  = TDungeonKernel<double, 2, FDungeonFastPredicates>;
+	using FKernel2fExact = TDungeonKernel<float,  2, FDungeonExactPredicates>;
+	using FKernel3fFast  = TDungeonKernel<float,  3, FDungeonFastPredicates>;
+	using FKernel3dFast  = TDungeonKernel<double, 3, FDungeonFastPredicates>;
+	using FKernel3fExact = TDungeonKernel<float,  3, FDungeonExactPredicates>;
+
+	UE_LOG(LogDungeon, Display, TEXT("Dungeon kernel benchmark: %d points, best of %d, seed %d"), NumPoints, Iterations, Seed);
+
+	UE_LOG(LogDungeon, Display, TEXT("Delaunay 2D"));
+	BenchDelaunay<FKernel2fFast>   (TEXT("float  / fast"),  NumPoints, Seed, Iterations);
+	BenchDelaunay<FKernel2dFast>   (TEXT("double / fast"),  NumPoints, Seed, Iterations);
+	BenchDelaunay<FKernel2fExact>  (TEXT("float  / exact"), NumPoints, Seed, Iterations);
+	BenchDelaunay<FDungeonKernel2D>(TEXT("double / exact"), NumPoints, Seed, Iterations);
+
+	UE_LOG(LogDungeon, Display, TEXT("Delaunay 3D"));
+	BenchTetrahedralize<FKernel3fFast>   (TEXT("float  / fast"),  NumPoints, Seed, Iterations);
+	BenchTetrahedralize<FKernel3dFast>   (TEXT("double / fast"),  NumPoints, Seed, Iterations);
+	BenchTetrahedralize<FKernel3fExact>  (TEXT("float  / exact"), NumPoints, Seed, Iterations);
+	BenchTetrahedralize<FDungeonKernel3D>(TEXT("double / exact"), NumPoints, Seed, Iterations);
+
+	UE_LOG(LogDungeon, Display, TEXT("Segment / box clipping"));
+	BenchClip<FKernel2fFast>(TEXT("float  / 2D"), NumPoints, Seed, Iterations);
+	BenchClip<FKernel2dFast>(TEXT("double / 2D"), NumPoints, Seed, Iterations);
+	BenchClip<FKernel3fFast>(TEXT("float  / 3D"), NumPoints, Seed, Iterations);
+	BenchClip<FKernel3dFast>(TEXT("double / 3D"), NumPoints, Seed, Iterations);
+
+	// Layout réel sans couloirs : le graphe et le MST sont prêts, seul le style de couloir change
+	FDungeonGenParams GenParams = GetDefault<ADungeonGenerator>()->MakeGenParams();
+	GenParams.bBuildCorridors = false;
+	FDungeonLayout Layout;
+	FDungeonPipeline::Generate(GenParams, Seed, Layout);
+
+	UE_LOG(LogDungeon, Display, TEXT("Corridors (%d rooms, %d MST edges)"), Layout.Rooms.Num(), Layout.MSTEdges.Num());
+	BenchCorridors<EDungeonCorridorStyle::LShape>  (TEXT("L-shape"),  GenParams, Layout, Iterations);
+	BenchCorridors<EDungeonCorridorStyle::Straight>(TEXT("straight"), GenParams, Layout, Iterations);
+
+	// Grand donjon : disque de spawn et main rooms à l'échelle du nombre de salles. La relaxation à plat est
+	// quadratique, d'où un nombre d'itérations plafonné.
+	FDungeonGenParams Large = GetDefault<ADungeonGenerator>()->MakeGenParams();
+	const float Scale = static_cast<float>(NumRooms) / FMath::Max(1, Large.RoomsNbr);
+	Large.RoomsNbr = NumRooms;
+	Large.SpawnRadius *= FMath::Sqrt(Scale);
+	Large.MainCount = FMath::Max(Large.MainCount, FMath::RoundToInt(Large.MainCount * Scale));
+	Large.MaxCulls = FMath::Max(Large.MaxCulls, FMath::RoundToInt(Large.MaxCulls * Scale));
+	const int32 PipelineIterations = FMath::Min(Iterations, 3);
+
+	UE_LOG(LogDungeon, Display, TEXT("Pipeline (%d rooms, %d main rooms, best of %d)"), NumRooms, Large.MainCount, PipelineIterations);
+	Large.ClusterCount = 0;
+	const double FlatMs = BenchPipeline(TEXT("flat"), Large, Seed, PipelineIterations);
+	Large.ClusterCount = NumClusters;
+	const double ClusteredMs = BenchPipeline(*FString::Printf(TEXT("hierarchical / %d clusters"), NumClusters), Large, Seed, PipelineIterations);
+	UE_LOG(LogDungeon, Display, TEXT("  speedup x%.2f"), ClusteredMs > 0.0 ? FlatMs / ClusteredMs : 0.0);
+	return 0;
+}
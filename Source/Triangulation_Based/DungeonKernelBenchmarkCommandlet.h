@@ -0,0 +1,18 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "DungeonKernelBenchmarkCommandlet.generated.h"
+
+// Compare les instanciations du noyau géométrique (float/double, prédicats rapides/exacts), les styles de couloir
+// et la génération complète à plat / hiérarchique (ClusterCount) sur un grand donjon.
+// UnrealEditor-Cmd Triangulation_Based -run=DungeonKernelBenchmark [-Points=2000] [-Iterations=20] [-Seed=1] [-Rooms=4000] [-Clusters=16]
+UCLASS()
+class TRIANGULATION_BASED_API UDungeonKernelBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UDungeonKernelBenchmarkCommandlet();
+	virtual int32 Main(const FString& Params) override;
+};
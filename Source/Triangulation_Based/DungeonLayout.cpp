@@ -0,0 +1,189 @@
+#include "DungeonLayout.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/MemoryReader.h"
+
+static uint32 ZigZag(int32 V)   { return (static_cast<uint32>(V) << 1) ^ static_cast<uint32>(V >> 31); }
+static int32  UnZigZag(uint32 V) { return static_cast<int32>(V >> 1) ^ -static_cast<int32>(V & 1u); }
+
+static int32 QuantizeScalar(double V) { return FMath::RoundToInt(V / FDungeonLayout::Quantum); }
+
+FVector2D FDungeonLayout::Quantize(const FVector2D& V)
+{
+	return FVector2D(QuantizeScalar(V.X) * Quantum, QuantizeScalar(V.Y) * Quantum);
+}
+
+int32 FDungeonLayout::NumMainRooms() const
+{
+	int32 N = 0;
+	for (const FDungeonRoomDesc& R : Rooms) if (R.bIsMain) ++N;
+	return N;
+}
+
+SIZE_T FDungeonLayout::GetAllocatedSize() const
+{
+	return Rooms.GetAllocatedSize() + MSTEdges.GetAllocatedSize()
+		+ DelaunayTriangles.GetAllocatedSize() + DelaunayTetrahedra.GetAllocatedSize() + Corridors.GetAllocatedSize()
+		+ Props.GetAllocatedSize();
+}
+
+uint32 FDungeonLayout::ComputeDerivedCrc() const
+{
+	// Somme des CRC des éléments : commutative, et un élément en double ne s'annule pas comme avec un xor
+	uint32 Sum = 0;
+	int32 NumSegs = 0;
+	for (const FCorridorSeg& S : Corridors)
+	{
+		if (S.A == S.B && S.ZA == S.ZB) continue; // emplacement libéré par une mise à jour incrémentale
+		const int32 Q[6] = { QuantizeScalar(S.A.X), QuantizeScalar(S.A.Y), QuantizeScalar(S.ZA),
+		                     QuantizeScalar(S.B.X), QuantizeScalar(S.B.Y), QuantizeScalar(S.ZB) };
+		Sum += FCrc::MemCrc32(Q, sizeof(Q));
+		++NumSegs;
+	}
+	for (const FDungeonProp& P : Props)
+	{
+		const int32 Q[6] = { QuantizeScalar(P.Position.X), QuantizeScalar(P.Position.Y), FMath::RoundToInt32(P.Yaw),
+		                     FMath::RoundToInt32(P.Scale * 100.f), P.Floor, P.Rule };
+		Sum += FCrc::MemCrc32(Q, sizeof(Q), 1);
+	}
+	return HashCombine(HashCombine(Sum, GetTypeHash(NumSegs)), GetTypeHash(Props.Num()));
+}
+
+void FDungeonLayout::Pack(TArray<uint8>& OutBytes) const
+{
+	OutBytes.Reset();
+	FMemoryWriter Ar(OutBytes);
+
+	uint8 V = Version;
+	Ar << V;
+
+	uint32 NumRooms = Rooms.Num();
+	Ar.SerializeIntPacked(NumRooms);
+
+	// Étage par salle seulement si le donjon en a plusieurs : un donjon plat ne coûte qu'un octet de plus
+	uint32 NumFloors = 1;
+	for (const FDungeonRoomDesc& R : Rooms) NumFloors = FMath::Max(NumFloors, static_cast<uint32>(FMath::Max(0, R.Floor)) + 1);
+	Ar.SerializeIntPacked(NumFloors);
+
+	int32 PrevX = 0, PrevY = 0;
+	for (const FDungeonRoomDesc& R : Rooms)
+	{
+		const int32 QX = QuantizeScalar(R.Center.X);
+		const int32 QY = QuantizeScalar(R.Center.Y);
+
+		uint32 DX = ZigZag(QX - PrevX);
+		uint32 DY = ZigZag(QY - PrevY);
+		uint32 SX = (static_cast<uint32>(FMath::Max(0, QuantizeScalar(R.Size.X))) << 1) | (R.bIsMain ? 1u : 0u);
+		uint32 SY = static_cast<uint32>(FMath::Max(0, QuantizeScalar(R.Size.Y)));
+
+		Ar.SerializeIntPacked(DX);
+		Ar.SerializeIntPacked(DY);
+		Ar.SerializeIntPacked(SX);
+		Ar.SerializeIntPacked(SY);
+		if (NumFloors > 1)
+		{
+			uint32 F = static_cast<uint32>(FMath::Max(0, R.Floor));
+			Ar.SerializeIntPacked(F);
+		}
+
+		PrevX = QX; PrevY = QY;
+	}
+
+	uint32 NumEdges = MSTEdges.Num();
+	Ar.SerializeIntPacked(NumEdges);
+	for (const FDGEdge& E : MSTEdges)
+	{
+		uint32 A = static_cast<uint32>(E.A);
+		uint32 D = static_cast<uint32>(E.B - E.A);
+		Ar.SerializeIntPacked(A);
+		Ar.SerializeIntPacked(D);
+	}
+}
+
+bool FDungeonLayout::Unpack(const TArray<uint8>& Bytes)
+{
+	Rooms.Reset();
+	MSTEdges.Reset();
+	DelaunayTriangles.Reset();
+	DelaunayTetrahedra.Reset();
+	Corridors.Reset();
+
+	FMemoryReader Ar(Bytes);
+
+	uint8 V = 0;
+	Ar << V;
+	if (Ar.IsError() || V != Version) return false;
+
+	uint32 NumRooms = 0;
+	Ar.SerializeIntPacked(NumRooms);
+	if (Ar.IsError() || NumRooms > static_cast<uint32>(Bytes.Num())) return false;
+
+	uint32 NumFloors = 0;
+	Ar.SerializeIntPacked(NumFloors);
+	if (Ar.IsError() || NumFloors == 0 || NumFloors > MAX_uint16) return false;
+
+	Rooms.Reserve(NumRooms);
+	int32 PrevX = 0, PrevY = 0, NumMains = 0;
+	for (uint32 i = 0; i < NumRooms; ++i)
+	{
+		uint32 DX = 0, DY = 0, SX = 0, SY = 0, F = 0;
+		Ar.SerializeIntPacked(DX);
+		Ar.SerializeIntPacked(DY);
+		Ar.SerializeIntPacked(SX);
+		Ar.SerializeIntPacked(SY);
+		if (NumFloors > 1) Ar.SerializeIntPacked(F);
+		if (Ar.IsError() || F >= NumFloors) return false;
+
+		PrevX += UnZigZag(DX);
+		PrevY += UnZigZag(DY);
+
+		FDungeonRoomDesc& R = Rooms.AddDefaulted_GetRef();
+		R.Center  = FVector2D(PrevX * Quantum, PrevY * Quantum);
+		R.Size    = FVector2D((SX >> 1) * Quantum, SY * Quantum);
+		R.Floor   = static_cast<int32>(F);
+		R.bIsMain = (SX & 1u) != 0;
+		if (R.bIsMain) ++NumMains;
+	}
+
+	uint32 NumEdges = 0;
+	Ar.SerializeIntPacked(NumEdges);
+	if (Ar.IsError() || NumEdges > static_cast<uint32>(NumMains)) return false;
+
+	MSTEdges.Reserve(NumEdges);
+	for (uint32 i = 0; i < NumEdges; ++i)
+	{
+		uint32 A = 0, D = 0;
+		Ar.SerializeIntPacked(A);
+		Ar.SerializeIntPacked(D);
+		if (Ar.IsError() || A + D >= static_cast<uint32>(NumMains)) return false;
+		MSTEdges.Emplace(static_cast<int32>(A), static_cast<int32>(A + D));
+	}
+	return !Ar.IsError();
+}
+
+bool FDungeonLayoutNet::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	Ar << Seed;
+	Ar << ParamHash;
+	Ar << DerivedCrc;
+	Ar << LayoutId;
+
+	uint32 Total = static_cast<uint32>(TotalBytes);
+	Ar.SerializeIntPacked(Total);
+	uint32 Num = Packed.Num();
+	Ar.SerializeIntPacked(Num);
+	if (Ar.IsLoading())
+	{
+		if (Total > static_cast<uint32>(MaxStreamedBytes) || Num > static_cast<uint32>(MaxInlineBytes))
+		{
+			Ar.SetError();
+			bOutSuccess = false;
+			return false;
+		}
+		TotalBytes = static_cast<int32>(Total);
+		Packed.SetNumUninitialized(Num);
+	}
+	Ar.Serialize(Packed.GetData(), Num);
+
+	bOutSuccess = !Ar.IsError();
+	return true;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DungeonTypes.h"
+#include "DungeonLayout.generated.h"
+
+// Résultat final (après culling) d'une génération : seule donnée nécessaire pour reconstruire le donjon
+struct FDungeonLayout
+{
+	static constexpr float Quantum = 1.f;
+	static constexpr uint8 Version = 2;
+
+	int32  Seed = 0;
+	uint32 ParamHash = 0;
+	TArray<FDungeonRoomDesc> Rooms;
+	TArray<FDGEdge> MSTEdges; // indices dans les main rooms, dans l'ordre de Rooms
+
+	// Données dérivées, non répliquées (recalculées côté client)
+	TArray<FDGTriangle>  DelaunayTriangles;
+	TArray<FDGTetra>     DelaunayTetrahedra; // à la place des triangles en mode multi-étages
+	TArray<FCorridorSeg> Corridors;
+	TArray<FDungeonProp> Props;             // intérieur des salles, rejoué depuis la seed et les règles
+
+	int32 NumMainRooms() const;
+	SIZE_T GetAllocatedSize() const;
+
+	// Table quantifiée + delta-encodée (varints zigzag) ; trier les salles par X garde des deltas courts
+	void Pack(TArray<uint8>& OutBytes) const;
+	bool Unpack(const TArray<uint8>& Bytes);
+
+	// Empreinte des couloirs et des props, indépendante de leur ordre (un serveur qui a édité le donjon les range
+	// autrement qu'une reconstruction complète). Segments vides ignorés, valeurs quantifiées.
+	uint32 ComputeDerivedCrc() const;
+
+	static FVector2D Quantize(const FVector2D& V);
+};
+
+USTRUCT()
+struct FDungeonLayoutNet
+{
+	GENERATED_BODY()
+
+	// ~10 octets par salle (deltas de position, tailles, étage) et ~3 par arête du MST : la propriété porte
+	// environ 800 salles. Au-delà, Packed reste vide et UDungeonLayoutStreamComponent envoie les octets par
+	// morceaux, jusqu'à MaxStreamedBytes (~100 000 salles) ; plus gros, la publication est refusée.
+	static constexpr int32 MaxInlineBytes   = 8 * 1024;
+	static constexpr int32 MaxStreamedBytes = 1 << 20;
+
+	UPROPERTY() int32  Seed = 0;
+	UPROPERTY() uint32 ParamHash = 0;
+	UPROPERTY() uint32 DerivedCrc = 0; // FDungeonLayout::ComputeDerivedCrc du serveur, vérifié par les clients
+	UPROPERTY() int32  LayoutId = 0;   // incrémenté à chaque publication, relie la propriété aux morceaux du flux
+	UPROPERTY() int32  TotalBytes = 0; // taille du layout encodé, dans Packed ou dans le flux
+	UPROPERTY() TArray<uint8> Packed;
+
+	bool IsStreamed() const { return TotalBytes > MaxInlineBytes; }
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FDungeonLayoutNet> : public TStructOpsTypeTraitsBase2<FDungeonLayoutNet>
+{
+	enum { WithNetSerializer = true };
+};
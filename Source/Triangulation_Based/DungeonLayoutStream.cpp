@@ -0,0 +1,79 @@
+#include "DungeonLayoutStream.h"
+#include "DungeonGenerator.h"
+#include "Triangulation_Based.h"
+#include "GameFramework/PlayerController.h"
+
+UDungeonLayoutStreamComponent::UDungeonLayoutStreamComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false; // ne tourne que pendant un envoi
+	SetIsReplicatedByDefault(true);
+}
+
+void UDungeonLayoutStreamComponent::StreamTo(APlayerController* PC, ADungeonGenerator* Generator)
+{
+	if (!PC || !Generator || PC->IsLocalController()) return;
+
+	UDungeonLayoutStreamComponent* Stream = PC->FindComponentByClass<UDungeonLayoutStreamComponent>();
+	if (!Stream)
+	{
+		Stream = NewObject<UDungeonLayoutStreamComponent>(PC, TEXT("DungeonLayoutStream"));
+		Stream->RegisterComponent();
+	}
+
+	FOutgoing* Entry = Stream->Outgoing.FindByPredicate([Generator](const FOutgoing& O) { return O.Generator.Get() == Generator; });
+	if (!Entry) Entry = &Stream->Outgoing.AddDefaulted_GetRef();
+	Entry->Generator = Generator;
+	Entry->LayoutId  = INDEX_NONE;
+	Entry->Offset    = 0;
+
+	Stream->SetComponentTickEnabled(true);
+}
+
+void UDungeonLayoutStreamComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	int32 Budget = ChunksPerTick;
+	for (int32 i = 0; i < Outgoing.Num() && Budget > 0; )
+	{
+		FOutgoing& O = Outgoing[i];
+		ADungeonGenerator* Generator = O.Generator.Get();
+		const TArray<uint8>* Bytes = Generator ? &Generator->GetStreamedLayout() : nullptr;
+		if (!Bytes || Bytes->Num() == 0)
+		{
+			Outgoing.RemoveAtSwap(i);
+			continue;
+		}
+
+		// Layout republié pendant l'envoi (édition en cours de partie) : le client jette ce qu'il a reçu
+		if (O.LayoutId != Generator->GetPublishedLayoutId())
+		{
+			O.LayoutId = Generator->GetPublishedLayoutId();
+			O.Offset = 0;
+		}
+
+		while (Budget > 0 && O.Offset < Bytes->Num())
+		{
+			const int32 Num = FMath::Min(ChunkBytes, Bytes->Num() - O.Offset);
+			ClientLayoutChunk(Generator, O.LayoutId, Bytes->Num(), O.Offset, TArray<uint8>(Bytes->GetData() + O.Offset, Num));
+			O.Offset += Num;
+			--Budget;
+		}
+
+		if (O.Offset >= Bytes->Num())
+		{
+			UE_LOG(LogDungeon, Verbose, TEXT("Dungeon layout %d streamed to %s (%d bytes)"), O.LayoutId, *GetNameSafe(GetOwner()), Bytes->Num());
+			Outgoing.RemoveAtSwap(i);
+			continue;
+		}
+		++i;
+	}
+
+	if (Outgoing.Num() == 0) SetComponentTickEnabled(false);
+}
+
+void UDungeonLayoutStreamComponent::ClientLayoutChunk_Implementation(ADungeonGenerator* Generator, int32 LayoutId, int32 TotalBytes, int32 Offset, const TArray<uint8>& Bytes)
+{
+	if (Generator) Generator->ReceiveLayoutChunk(LayoutId, TotalBytes, Offset, Bytes);
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "DungeonLayoutStream.generated.h"
+
+// Flux fiable serveur -> client pour les layouts trop gros pour la propriété répliquée (FDungeonLayoutNet::MaxInlineBytes).
+// Ajouté par le serveur sur chaque PlayerController distant : un générateur n'appartient à aucune connexion et ne peut
+// pas recevoir de RPC Client lui-même. Quelques morceaux par tick pour ne pas saturer le buffer fiable du canal.
+UCLASS(Config=Game, ClassGroup=Dungeon)
+class TRIANGULATION_BASED_API UDungeonLayoutStreamComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	static constexpr int32 ChunkBytes = 1024;
+
+	UDungeonLayoutStreamComponent();
+
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	// Serveur : (re)démarre l'envoi du layout publié par Generator vers le client de PC
+	static void StreamTo(class APlayerController* PC, class ADungeonGenerator* Generator);
+
+	UFUNCTION(Client, Reliable)
+	void ClientLayoutChunk(class ADungeonGenerator* Generator, int32 LayoutId, int32 TotalBytes, int32 Offset, const TArray<uint8>& Bytes);
+
+	UPROPERTY(Config, EditAnywhere, Category="DungeonStream", meta=(ClampMin=1)) int32 ChunksPerTick = 8;
+
+private:
+	struct FOutgoing
+	{
+		TWeakObjectPtr<class ADungeonGenerator> Generator;
+		int32 LayoutId = INDEX_NONE; // layout en cours d'envoi ; un nouveau PublishLayout fait repartir de zéro
+		int32 Offset = 0;
+	};
+	TArray<FOutgoing> Outgoing;
+};
@@ -0,0 +1,192 @@
+#include "DungeonLinkCutForest.h"
+
+void FDungeonLinkCutForest::Reset()
+{
+	Parent.Reset();
+	Child[0].Reset();
+	Child[1].Reset();
+	Max.Reset();
+	Flip.Reset();
+	Weights.Reset();
+	Edges.Reset();
+	Free.Reset();
+}
+
+int32 FDungeonLinkCutForest::NewNode(double Weight, const FDGEdge& Edge)
+{
+	int32 X;
+	if (Free.Num() > 0)
+	{
+		X = Free.Pop(EAllowShrinking::No);
+	}
+	else
+	{
+		X = Parent.AddUninitialized();
+		Child[0].AddUninitialized();
+		Child[1].AddUninitialized();
+		Max.AddUninitialized();
+		Flip.AddUninitialized();
+		Weights.AddUninitialized();
+		Edges.AddUninitialized();
+	}
+	Parent[X] = Child[0][X] = Child[1][X] = INDEX_NONE;
+	Flip[X] = 0;
+	Weights[X] = Weight;
+	Edges[X] = Edge;
+	Max[X] = Weight >= 0.0 ? X : INDEX_NONE;
+	return X;
+}
+
+int32 FDungeonLinkCutForest::AddVertexNode()
+{
+	return NewNode(-1.0, FDGEdge());
+}
+
+int32 FDungeonLinkCutForest::AddEdgeNode(const FDGEdge& Edge, double Weight)
+{
+	return NewNode(Weight, Edge);
+}
+
+void FDungeonLinkCutForest::FreeNode(int32 Node)
+{
+	Free.Add(Node);
+}
+
+bool FDungeonLinkCutForest::Heavier(double WA, const FDGEdge& A, double WB, const FDGEdge& B)
+{
+	if (WA != WB) return WA > WB;
+	return (A.A != B.A) ? A.A > B.A : A.B > B.B;
+}
+
+int32 FDungeonLinkCutForest::HeavierNode(int32 A, int32 B) const
+{
+	if (A == INDEX_NONE) return B;
+	if (B == INDEX_NONE) return A;
+	return Heavier(Weights[A], Edges[A], Weights[B], Edges[B]) ? A : B;
+}
+
+bool FDungeonLinkCutForest::IsSplayRoot(int32 X) const
+{
+	const int32 P = Parent[X];
+	return P == INDEX_NONE || (Child[0][P] != X && Child[1][P] != X);
+}
+
+void FDungeonLinkCutForest::Push(int32 X)
+{
+	if (!Flip[X]) return;
+	Swap(Child[0][X], Child[1][X]);
+	for (int32 s = 0; s < 2; ++s)
+		if (Child[s][X] != INDEX_NONE) Flip[Child[s][X]] ^= 1;
+	Flip[X] = 0;
+}
+
+void FDungeonLinkCutForest::Pull(int32 X)
+{
+	int32 M = Weights[X] >= 0.0 ? X : INDEX_NONE;
+	for (int32 s = 0; s < 2; ++s)
+		if (Child[s][X] != INDEX_NONE) M = HeavierNode(M, Max[Child[s][X]]);
+	Max[X] = M;
+}
+
+void FDungeonLinkCutForest::Rotate(int32 X)
+{
+	const int32 P = Parent[X];
+	const int32 G = Parent[P];
+	const int32 Side = Child[1][P] == X ? 1 : 0;
+
+	if (!IsSplayRoot(P)) Child[Child[1][G] == P ? 1 : 0][G] = X;
+	Parent[X] = G;
+
+	Child[Side][P] = Child[1 - Side][X];
+	if (Child[Side][P] != INDEX_NONE) Parent[Child[Side][P]] = P;
+	Child[1 - Side][X] = P;
+	Parent[P] = X;
+
+	Pull(P);
+	Pull(X);
+}
+
+void FDungeonLinkCutForest::Splay(int32 X)
+{
+	// Inversions en attente propagées du haut vers le bas avant les rotations
+	Path.Reset();
+	Path.Add(X);
+	for (int32 Y = X; !IsSplayRoot(Y); Y = Parent[Y]) Path.Add(Parent[Y]);
+	for (int32 i = Path.Num() - 1; i >= 0; --i) Push(Path[i]);
+
+	while (!IsSplayRoot(X))
+	{
+		const int32 P = Parent[X];
+		if (!IsSplayRoot(P))
+		{
+			const int32 G = Parent[P];
+			const bool bZigZig = (Child[0][G] == P) == (Child[0][P] == X);
+			Rotate(bZigZig ? P : X);
+		}
+		Rotate(X);
+	}
+}
+
+void FDungeonLinkCutForest::Access(int32 X)
+{
+	int32 Last = INDEX_NONE;
+	for (int32 Y = X; Y != INDEX_NONE; Y = Parent[Y])
+	{
+		Splay(Y);
+		Child[1][Y] = Last;
+		Pull(Y);
+		Last = Y;
+	}
+	Splay(X);
+}
+
+void FDungeonLinkCutForest::MakeRoot(int32 X)
+{
+	Access(X);
+	Flip[X] ^= 1;
+}
+
+int32 FDungeonLinkCutForest::FindRoot(int32 X)
+{
+	Access(X);
+	int32 R = X;
+	for (;;)
+	{
+		Push(R);
+		if (Child[0][R] == INDEX_NONE) break;
+		R = Child[0][R];
+	}
+	Splay(R);
+	return R;
+}
+
+void FDungeonLinkCutForest::Link(int32 U, int32 V)
+{
+	MakeRoot(U);
+	Parent[U] = V;
+}
+
+void FDungeonLinkCutForest::Cut(int32 U, int32 V)
+{
+	MakeRoot(U);
+	Access(V);
+	// U est alors le fils gauche de V, sans fils droit : le lien U-V est la seule arête du chemin
+	if (Child[0][V] != U) return;
+	Push(U);
+	if (Child[1][U] != INDEX_NONE) return;
+	Child[0][V] = INDEX_NONE;
+	Parent[U] = INDEX_NONE;
+	Pull(V);
+}
+
+bool FDungeonLinkCutForest::Connected(int32 U, int32 V)
+{
+	return U == V || FindRoot(U) == FindRoot(V);
+}
+
+int32 FDungeonLinkCutForest::PathMax(int32 U, int32 V)
+{
+	MakeRoot(U);
+	Access(V);
+	return Max[V];
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DungeonTypes.h"
+
+// Forêt dynamique (link-cut trees de Sleator–Tarjan) : lier, couper, tester la connexité et trouver l'arête
+// la plus lourde d'un chemin, chacun en O(log n) amorti. Les arêtes sont des noeuds portant leur poids,
+// les sommets des noeuds sans poids : le maximum d'un chemin est alors celui de ses noeuds-arêtes.
+struct TRIANGULATION_BASED_API FDungeonLinkCutForest
+{
+	void Reset();
+
+	int32 AddVertexNode();
+	int32 AddEdgeNode(const FDGEdge& Edge, double Weight);
+	void  FreeNode(int32 Node);
+
+	void Link(int32 U, int32 V);
+	void Cut(int32 U, int32 V);
+	bool Connected(int32 U, int32 V);
+
+	// Noeud-arête le plus lourd entre U et V (même arbre), INDEX_NONE si U == V
+	int32 PathMax(int32 U, int32 V);
+
+	const FDGEdge& GetEdge(int32 Node) const { return Edges[Node]; }
+	double GetWeight(int32 Node) const { return Weights[Node]; }
+
+	// Ordre total des arêtes (poids puis indices), le même que BuildMST_Kruskal : le MST est unique
+	static bool Heavier(double WA, const FDGEdge& A, double WB, const FDGEdge& B);
+
+private:
+	TArray<int32> Parent;
+	TArray<int32> Child[2];
+	TArray<int32> Max;      // noeud-arête le plus lourd du sous-arbre splay
+	TArray<uint8> Flip;     // inversion paresseuse (MakeRoot)
+	TArray<double> Weights; // < 0 : noeud-sommet
+	TArray<FDGEdge> Edges;
+	TArray<int32> Free;
+	TArray<int32> Path;     // pile de Splay, gardée pour éviter une allocation par accès
+
+	int32 NewNode(double Weight, const FDGEdge& Edge);
+	bool IsSplayRoot(int32 X) const;
+	int32 HeavierNode(int32 A, int32 B) const;
+	void Push(int32 X);
+	void Pull(int32 X);
+	void Rotate(int32 X);
+	void Splay(int32 X);
+	void Access(int32 X);
+	void MakeRoot(int32 X);
+	int32 FindRoot(int32 X);
+};
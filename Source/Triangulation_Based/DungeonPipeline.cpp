@@ -0,0 +1,1418 @@
+#include "DungeonPipeline.h"
+#include "DungeonTetrahedralizer.h"
+#include "Triangulation_Based.h"
+#include "Algo/BinarySearch.h"
+#include "Algo/Sort.h"
+#include "Algo/Unique.h"
+#include "Async/ParallelFor.h"
+#include <cfloat>
+
+uint32 FDungeonGenParams::GetHash() const
+{
+	uint32 H = GetTypeHash(RoomsNbr);
+	H = HashCombine(H, GetTypeHash(RoomSizeMin));
+	H = HashCombine(H, GetTypeHash(RoomSizeMax));
+	H = HashCombine(H, GetTypeHash(SpawnRadius));
+	H = HashCombine(H, GetTypeHash(PlacementMode));
+	H = HashCombine(H, GetTypeHash(PoissonCandidates));
+	H = HashCombine(H, GetTypeHash(FloorCount));
+	H = HashCombine(H, GetTypeHash(FloorHeight));
+	H = HashCombine(H, GetTypeHash(MaxRelaxIterations));
+	H = HashCombine(H, GetTypeHash(NudgeClamp));
+	H = HashCombine(H, GetTypeHash(ContactPadding));
+	H = HashCombine(H, GetTypeHash(bEnableCulling));
+	H = HashCombine(H, GetTypeHash(CullPenetrationThreshold));
+	H = HashCombine(H, GetTypeHash(MaxCulls));
+	H = HashCombine(H, GetTypeHash(MainCount));
+	H = HashCombine(H, GetTypeHash(MinMainGap));
+	H = HashCombine(H, GetTypeHash(ClusterCount));
+	H = HashCombine(H, GetTypeHash(bBuildCorridors));
+	H = HashCombine(H, GetTypeHash(bKeepOnlyMainAndPath));
+	H = HashCombine(H, GetTypeHash(CorridorKeepDistance));
+	H = HashCombine(H, GetTypeHash(bCorridorFollowMSTExact));
+	H = HashCombine(H, GetTypeHash(Props.DensityPerSquareMeter));
+	H = HashCombine(H, GetTypeHash(Props.MaxPerRoom));
+	H = HashCombine(H, GetTypeHash(Props.WallMargin));
+	H = HashCombine(H, GetTypeHash(Props.CorridorClearance));
+	H = HashCombine(H, GetTypeHash(Props.MaxAttemptsPerProp));
+	for (const FDungeonPropRule& R : Props.Rules)
+	{
+		H = HashCombine(H, GetTypeHash(R.Entry));
+		H = HashCombine(H, GetTypeHash(R.Weight));
+		H = HashCombine(H, GetTypeHash(R.Radius));
+		H = HashCombine(H, GetTypeHash(R.ScaleRange));
+		H = HashCombine(H, GetTypeHash(R.bSnapYawTo90));
+		H = HashCombine(H, GetTypeHash(R.bMainRoomsOnly));
+	}
+	return H;
+}
+
+FString FDungeonGenStats::ToString() const
+{
+	FString Out = FString::Printf(
+		TEXT("total %.2f ms (place %.2f, relax %.2f x%d, cull %.2f -%d, main %.2f, graph %.2f, corridors %.2f, props %.2f)"),
+		TotalMs, PlaceMs, RelaxMs, RelaxIterations, CullMs, Culled, MainRoomsMs, GraphMs, CorridorsMs, PropsMs);
+	if (Clusters > 0) Out += FString::Printf(TEXT(", %d clusters in %.2f ms"), Clusters, ClusterMs);
+	if (Assets > 0) Out += FString::Printf(TEXT(", %d assets loaded in %.2f ms (wait %.2f)"), Assets, AssetLoadMs, AssetWaitMs);
+	return Out;
+}
+
+void FDungeonGenStats::SampleMemory(FDungeonStageMemory& Stage, SIZE_T Bytes)
+{
+	Stage.CurrentBytes = Bytes;
+	Stage.PeakBytes = FMath::Max(Stage.PeakBytes, Bytes);
+	PeakBytes = FMath::Max(PeakBytes, Bytes);
+}
+
+FString FDungeonGenStats::MemoryToString() const
+{
+	auto KB = [](SIZE_T Bytes) { return Bytes / 1024.0; };
+	auto Stage = [&KB](const TCHAR* Name, const FDungeonStageMemory& M)
+	{
+		return FString::Printf(TEXT("%s %.1f/%.1f"), Name, KB(M.CurrentBytes), KB(M.PeakBytes));
+	};
+	return FString::Printf(TEXT("peak %.1f KB%s (current/peak KB: %s, %s, %s, %s, %s, %s, %s), rooms %.1f KB"),
+		KB(PeakBytes), bCompact ? TEXT(" compact") : TEXT(""),
+		*Stage(TEXT("place"), PlaceMem), *Stage(TEXT("relax"), RelaxMem), *Stage(TEXT("cull"), CullMem),
+		*Stage(TEXT("main"), MainRoomsMem), *Stage(TEXT("graph"), GraphMem), *Stage(TEXT("corridors"), CorridorsMem),
+		*Stage(TEXT("props"), PropsMem), KB(SpawnBytes));
+}
+
+struct FStageTimer
+{
+	double Start = FPlatformTime::Seconds();
+	double Lap()
+	{
+		const double Now = FPlatformTime::Seconds();
+		const double Ms = (Now - Start) * 1000.0;
+		Start = Now;
+		return Ms;
+	}
+};
+
+void FDungeonPipeline::Generate(const FDungeonGenParams& P, int32 Seed, FDungeonLayout& Out, FDungeonGenStats* Stats)
+{
+	LLM_SCOPE_BYTAG(Dungeon_Generation);
+
+	FDungeonGenStats Local;
+	FDungeonGenStats& S = Stats ? *Stats : Local;
+	S = FDungeonGenStats();
+	S.bCompact = P.bCompactLayout;
+
+	if (P.ClusterCount > 1)
+	{
+		GenerateHierarchical(P, Seed, Out, S);
+		return;
+	}
+
+	const double T0 = FPlatformTime::Seconds();
+	TArray<FRoomRef> Refs;
+	PlaceAndRelax(P, Seed, Refs, S);
+
+	Out.Seed = Seed;
+	Finish(P, Refs, Out, &S);
+
+	S.TotalMs = (FPlatformTime::Seconds() - T0) * 1000.0;
+}
+
+void FDungeonPipeline::PlaceAndRelax(const FDungeonGenParams& P, int32 Seed, TArray<FRoomRef>& Refs, FDungeonGenStats& S)
+{
+	LLM_SCOPE_BYTAG(Dungeon_Generation);
+
+	FStageTimer Timer;
+	FRandomStream Rng(Seed);
+	Refs.Reset();
+	if (P.PlacementMode == EDungeonPlacementMode::PoissonDisk) PlaceRoomsPoisson(P, Rng, Refs);
+	else PlaceRooms(P, Rng, Refs);
+	S.PlaceMs = Timer.Lap();
+	S.SampleMemory(S.PlaceMem, Refs.GetAllocatedSize());
+
+	auto Relax = (P.FloorCount > 1) ? &RelaxOnceFloors : &RelaxOnce;
+
+	for (int32 it = 0; it < P.MaxRelaxIterations; ++it)
+	{
+		++S.RelaxIterations;
+		if (Relax(P, Refs) == 0) break;
+	}
+	S.RelaxMs = Timer.Lap();
+	S.SampleMemory(S.RelaxMem, Refs.GetAllocatedSize());
+
+	if (P.bEnableCulling)
+	{
+		for (int32 it = 0; it < 10; ++it)
+		{
+			if (Relax(P, Refs) == 0) break;
+		}
+		S.Culled = CullResidualOverlaps(P, Refs);
+		if (P.bCompactLayout) Refs.Shrink();
+	}
+	S.CullMs = Timer.Lap();
+	S.SampleMemory(S.CullMem, Refs.GetAllocatedSize());
+}
+
+void FDungeonPipeline::GenerateHierarchical(const FDungeonGenParams& P, int32 Seed, FDungeonLayout& Out, FDungeonGenStats& S)
+{
+	LLM_SCOPE_BYTAG(Dungeon_Generation);
+
+	const double T0 = FPlatformTime::Seconds();
+	FStageTimer Timer;
+	const int32 K = FMath::Clamp(P.ClusterCount, 1, FMath::Max(1, P.RoomsNbr));
+	S.Clusters = K;
+
+	// 1. Groupes indépendants : chacun sa part des salles, des main rooms, des culls et du disque de spawn
+	struct FCluster
+	{
+		FDungeonGenParams Params;
+		TArray<FRoomRef> Refs;
+		FDungeonGenStats Stats;
+		double Radius = 0.0;
+	};
+	TArray<FCluster> Clusters;
+	Clusters.SetNum(K);
+	for (int32 k = 0; k < K; ++k)
+	{
+		FDungeonGenParams& CP = Clusters[k].Params;
+		CP = P;
+		CP.ClusterCount = 0;
+		CP.RoomsNbr     = P.RoomsNbr / K + (k < P.RoomsNbr % K ? 1 : 0);
+		CP.MainCount    = FMath::Max(1, P.MainCount / K + (k < P.MainCount % K ? 1 : 0));
+		CP.MaxCulls     = FMath::DivideAndRoundUp(FMath::Max(0, P.MaxCulls), K);
+		CP.SpawnRadius  = P.SpawnRadius / FMath::Sqrt(static_cast<float>(K));
+	}
+
+	// Marge autour de chaque groupe : deux main rooms de groupes voisins restent au-delà de MinMainGap
+	const double Margin = P.MinMainGap + P.ContactPadding;
+	ParallelFor(K, [&Clusters, Seed, Margin](int32 k)
+	{
+		LLM_SCOPE_BYTAG(Dungeon_Generation);
+		FCluster& C = Clusters[k];
+		PlaceAndRelax(C.Params, static_cast<int32>(HashCombine(GetTypeHash(Seed), GetTypeHash(k))), C.Refs, C.Stats);
+		SelectMainRooms(C.Params, C.Refs);
+		if (C.Refs.Num() == 0) return;
+
+		// Recentré sur l'origine, rayon du disque englobant
+		FVector2D Centroid = FVector2D::ZeroVector;
+		for (const FRoomRef& R : C.Refs) Centroid += R.Center;
+		Centroid /= C.Refs.Num();
+		for (FRoomRef& R : C.Refs)
+		{
+			R.Center -= Centroid;
+			R.Cluster = k;
+			C.Radius = FMath::Max(C.Radius, R.Center.Size() + R.Half.Size());
+		}
+		C.Radius += Margin;
+	});
+
+	// 2. Groupes posés sur une spirale de Vogel dans le disque de spawn, puis écartés
+	TArray<FVector2D> Offsets;
+	TArray<double> Radii;
+	Offsets.Reserve(K);
+	Radii.Reserve(K);
+	const double Golden = PI * (3.0 - FMath::Sqrt(5.0));
+	for (int32 k = 0; k < K; ++k)
+	{
+		const double r = P.SpawnRadius * FMath::Sqrt((k + 0.5) / K);
+		Offsets.Add(FVector2D(r * FMath::Cos(k * Golden), r * FMath::Sin(k * Golden)));
+		Radii.Add(Clusters[k].Radius);
+	}
+	SeparateClusterDisks(Offsets, Radii);
+
+	// Les groupes tournent en même temps : temps = le plus lent, mémoire = la somme
+	int32 NumRooms = 0;
+	SIZE_T PlaceBytes = 0, RelaxBytes = 0, CullBytes = 0;
+	for (const FCluster& C : Clusters)
+	{
+		NumRooms += C.Refs.Num();
+		S.PlaceMs = FMath::Max(S.PlaceMs, C.Stats.PlaceMs);
+		S.RelaxMs = FMath::Max(S.RelaxMs, C.Stats.RelaxMs);
+		S.CullMs  = FMath::Max(S.CullMs, C.Stats.CullMs);
+		S.RelaxIterations = FMath::Max(S.RelaxIterations, C.Stats.RelaxIterations);
+		S.Culled += C.Stats.Culled;
+		PlaceBytes += C.Stats.PlaceMem.PeakBytes;
+		RelaxBytes += C.Stats.RelaxMem.PeakBytes;
+		CullBytes  += C.Stats.CullMem.PeakBytes;
+	}
+	S.SampleMemory(S.PlaceMem, PlaceBytes);
+	S.SampleMemory(S.RelaxMem, RelaxBytes);
+	S.SampleMemory(S.CullMem, CullBytes);
+
+	TArray<FRoomRef> Refs;
+	Refs.Reserve(NumRooms);
+	for (int32 k = 0; k < K; ++k)
+	{
+		for (FRoomRef& R : Clusters[k].Refs)
+		{
+			R.Center += Offsets[k];
+			Refs.Add(R);
+		}
+		Clusters[k].Refs.Empty();
+	}
+	S.ClusterMs = Timer.Lap();
+
+	// 3. Layout : mêmes quantification et tri que la génération à plat
+	SnapToLayoutGrid(Refs);
+	Out.Seed = Seed;
+	CopyRoomsToLayout(Refs, Out);
+
+	TArray<TArray<int32>> ClusterMains; // indices des main rooms (espace du MST) par groupe
+	ClusterMains.SetNum(K);
+	{
+		int32 m = 0;
+		for (const FRoomRef& R : Refs)
+			if (R.bIsMain) ClusterMains[R.Cluster].Add(m++);
+	}
+	S.SampleMemory(S.MainRoomsMem, Refs.GetAllocatedSize() + Out.GetAllocatedSize());
+	if (P.bCompactLayout) Refs.Empty();
+	S.MainRoomsMs = Timer.Lap();
+
+	// 4. Graphe et MST de chaque groupe en parallèle, sur les seules main rooms du groupe
+	TArray<FVector> Points;
+	MainRoomCenters3D(Out, P.FloorHeight, Points);
+
+	struct FClusterGraph
+	{
+		TArray<FDGEdge> MST;
+		TArray<FDGTriangle> Triangles;
+		TArray<FDGTetra> Tetrahedra;
+	};
+	TArray<FClusterGraph> Graphs;
+	Graphs.SetNum(K);
+	ParallelFor(K, [&P, &Points, &ClusterMains, &Graphs](int32 k)
+	{
+		LLM_SCOPE_BYTAG(Dungeon_Generation);
+		const TArray<int32>& Mains = ClusterMains[k];
+		FClusterGraph& G = Graphs[k];
+		TSet<FDGEdge> Edges;
+		TArray<FDGEdge> Local;
+		if (P.FloorCount > 1)
+		{
+			TArray<FVector> Pts;
+			Pts.Reserve(Mains.Num());
+			for (int32 m : Mains) Pts.Add(Points[m]);
+			FDungeonTetrahedralizer::Build(Pts, G.Tetrahedra, Edges);
+			BuildMST_Kruskal(Pts, Edges, Local);
+			for (FDGTetra& T : G.Tetrahedra) T = FDGTetra(Mains[T.I], Mains[T.J], Mains[T.K], Mains[T.L]);
+		}
+		else
+		{
+			TArray<FVector2D> Pts;
+			Pts.Reserve(Mains.Num());
+			for (int32 m : Mains) Pts.Add(FVector2D(Points[m]));
+			BuildDelaunay(Pts, G.Triangles);
+			EdgesFromTriangles(G.Triangles, Edges);
+			if (Pts.Num() == 2) Edges.Add(FDGEdge(0, 1)); // pas de triangle avec deux main rooms
+			BuildMST_Prim(Pts, Edges, Local);
+			for (FDGTriangle& T : G.Triangles) T = FDGTriangle(Mains[T.I], Mains[T.J], Mains[T.K]);
+		}
+		G.MST.Reserve(Local.Num());
+		for (const FDGEdge& E : Local) G.MST.Add(FDGEdge(Mains[E.A], Mains[E.B]));
+		if (P.bCompactLayout)
+		{
+			G.Triangles.Empty();
+			G.Tetrahedra.Empty();
+		}
+	});
+
+	// 5. Liaison des groupes : Delaunay sur un représentant par groupe (la main room la plus proche du
+	// barycentre de ses main rooms), chaque paire voisine reliée par ses deux main rooms les plus proches, puis Kruskal
+	TArray<int32> RepCluster;
+	TArray<FVector2D> RepPoints;
+	for (int32 k = 0; k < K; ++k)
+	{
+		const TArray<int32>& Mains = ClusterMains[k];
+		if (Mains.Num() == 0) continue;
+		FVector Centroid = FVector::ZeroVector;
+		for (int32 m : Mains) Centroid += Points[m];
+		Centroid /= Mains.Num();
+		int32 Rep = Mains[0];
+		for (int32 m : Mains)
+			if (FVector::DistSquared(Points[m], Centroid) < FVector::DistSquared(Points[Rep], Centroid)) Rep = m;
+		RepCluster.Add(k);
+		RepPoints.Add(FVector2D(Points[Rep]));
+	}
+
+	auto LinkClusters = [&Points, &ClusterMains, &RepCluster](const TSet<FDGEdge>& Pairs, TArray<FDGEdge>& OutLinks)
+	{
+		TArray<TPair<double, FDGEdge>> Candidates; // distance, paire de représentants
+		TArray<FDGEdge> Boundary;                  // main rooms de frontière de chaque candidat
+		for (const FDGEdge& Pair : Pairs)
+		{
+			double Best = TNumericLimits<double>::Max();
+			FDGEdge BestEdge;
+			for (int32 a : ClusterMains[RepCluster[Pair.A]])
+				for (int32 b : ClusterMains[RepCluster[Pair.B]])
+				{
+					const double d = FVector::DistSquared(Points[a], Points[b]);
+					if (d < Best) { Best = d; BestEdge = FDGEdge(a, b); }
+				}
+			Candidates.Emplace(Best, FDGEdge(Pair.A, Pair.B));
+			Boundary.Add(BestEdge);
+		}
+		TArray<int32> Order;
+		Order.Reserve(Candidates.Num());
+		for (int32 i = 0; i < Candidates.Num(); ++i) Order.Add(i);
+		Algo::Sort(Order, [&Candidates](int32 L, int32 R)
+		{
+			if (Candidates[L].Key != Candidates[R].Key) return Candidates[L].Key < Candidates[R].Key;
+			const FDGEdge& EL = Candidates[L].Value;
+			const FDGEdge& ER = Candidates[R].Value;
+			return (EL.A != ER.A) ? EL.A < ER.A : EL.B < ER.B;
+		});
+
+		TArray<int32> Parent;
+		Parent.SetNumUninitialized(RepCluster.Num());
+		for (int32 i = 0; i < Parent.Num(); ++i) Parent[i] = i;
+		auto Find = [&Parent](int32 X)
+		{
+			while (Parent[X] != X) { Parent[X] = Parent[Parent[X]]; X = Parent[X]; }
+			return X;
+		};
+		OutLinks.Reset();
+		for (int32 i : Order)
+		{
+			const int32 RA = Find(Candidates[i].Value.A);
+			const int32 RB = Find(Candidates[i].Value.B);
+			if (RA == RB) continue;
+			Parent[RA] = RB;
+			OutLinks.Add(Boundary[i]);
+		}
+	};
+
+	TArray<FDGEdge> Links;
+	if (RepPoints.Num() > 1)
+	{
+		TArray<FDGTriangle> RepTriangles;
+		TSet<FDGEdge> Pairs;
+		BuildDelaunay(RepPoints, RepTriangles);
+		EdgesFromTriangles(RepTriangles, Pairs);
+		LinkClusters(Pairs, Links);
+		if (Links.Num() < RepPoints.Num() - 1)
+		{
+			// Représentants alignés ou trop peu nombreux pour une triangulation : toutes les paires
+			Pairs.Reset();
+			for (int32 i = 0; i < RepPoints.Num(); ++i)
+				for (int32 j = i + 1; j < RepPoints.Num(); ++j) Pairs.Add(FDGEdge(i, j));
+			LinkClusters(Pairs, Links);
+		}
+	}
+
+	Out.MSTEdges.Reset();
+	Out.DelaunayTriangles.Reset();
+	Out.DelaunayTetrahedra.Reset();
+	for (FClusterGraph& G : Graphs)
+	{
+		Out.MSTEdges.Append(G.MST);
+		Out.DelaunayTriangles.Append(G.Triangles);
+		Out.DelaunayTetrahedra.Append(G.Tetrahedra);
+	}
+	Out.MSTEdges.Append(Links);
+	S.SampleMemory(S.GraphMem, Refs.GetAllocatedSize() + Out.GetAllocatedSize() + Points.GetAllocatedSize());
+	S.GraphMs = Timer.Lap();
+
+	FinishCorridors(P, Out, &S, Refs.GetAllocatedSize());
+	Refs.Empty();
+	FinishProps(P, Out, &S);
+
+	S.TotalMs = (FPlatformTime::Seconds() - T0) * 1000.0;
+}
+
+void FDungeonPipeline::Finish(const FDungeonGenParams& P, TArray<FRoomRef>& Refs, FDungeonLayout& Out, FDungeonGenStats* Stats)
+{
+	FinishGraph(P, Refs, Out, Stats);
+	FinishProps(P, Out, Stats);
+}
+
+void FDungeonPipeline::FinishGraph(const FDungeonGenParams& P, TArray<FRoomRef>& Refs, FDungeonLayout& Out, FDungeonGenStats* Stats)
+{
+	LLM_SCOPE_BYTAG(Dungeon_Generation);
+
+	FStageTimer Timer;
+	auto LiveBytes = [&Refs, &Out]() { return Refs.GetAllocatedSize() + Out.GetAllocatedSize(); };
+
+	SelectMainRooms(P, Refs);
+	SnapToLayoutGrid(Refs);
+
+	CopyRoomsToLayout(Refs, Out);
+	if (Stats) Stats->SampleMemory(Stats->MainRoomsMem, LiveBytes());
+
+	// Mode compact : les salles de travail ne servent plus une fois copiées dans le layout (Refs est vidé)
+	if (P.bCompactLayout) Refs.Empty();
+	if (Stats) Stats->MainRoomsMs = Timer.Lap();
+
+	// En mode compact, triangles et tétraèdres restent locaux : seul le MST est gardé
+	TArray<FDGTriangle> LocalTriangles;
+	TArray<FDGTetra> LocalTetrahedra;
+	TArray<FDGTriangle>& Triangles = P.bCompactLayout ? LocalTriangles : Out.DelaunayTriangles;
+	TArray<FDGTetra>& Tetrahedra = P.bCompactLayout ? LocalTetrahedra : Out.DelaunayTetrahedra;
+
+	TSet<FDGEdge> GraphEdges;
+	Out.DelaunayTriangles.Reset();
+	Out.DelaunayTetrahedra.Reset();
+	if (P.FloorCount > 1)
+	{
+		TArray<FVector> Points;
+		MainRoomCenters3D(Out, P.FloorHeight, Points);
+		FDungeonTetrahedralizer::Build(Points, Tetrahedra, GraphEdges);
+		BuildMST_Kruskal(Points, GraphEdges, Out.MSTEdges);
+		if (Stats) Stats->SampleMemory(Stats->GraphMem, LiveBytes() + Points.GetAllocatedSize() + GraphEdges.GetAllocatedSize() + LocalTetrahedra.GetAllocatedSize());
+	}
+	else
+	{
+		TArray<FVector2D> Points;
+		MainRoomCenters(Out, Points);
+		BuildDelaunay(Points, Triangles);
+		EdgesFromTriangles(Triangles, GraphEdges);
+		BuildMST_Prim(Points, GraphEdges, Out.MSTEdges);
+		if (Stats) Stats->SampleMemory(Stats->GraphMem, LiveBytes() + Points.GetAllocatedSize() + GraphEdges.GetAllocatedSize() + LocalTriangles.GetAllocatedSize());
+	}
+	if (Stats) Stats->GraphMs = Timer.Lap();
+
+	FinishCorridors(P, Out, Stats, Refs.GetAllocatedSize());
+}
+
+void FDungeonPipeline::FinishCorridors(const FDungeonGenParams& P, FDungeonLayout& Out, FDungeonGenStats* Stats, SIZE_T WorkBytes)
+{
+	FStageTimer Timer;
+	Out.Corridors.Reset();
+	if (P.bBuildCorridors)
+	{
+		BuildCorridors(P, Out);
+		KeepMainAndCorridorRooms(P, Out);
+	}
+	if (P.bCompactLayout)
+	{
+		Out.Rooms.Shrink();
+		Out.MSTEdges.Shrink();
+		Out.Corridors.Shrink();
+	}
+	if (Stats) Stats->SampleMemory(Stats->CorridorsMem, WorkBytes + Out.GetAllocatedSize());
+	if (Stats) Stats->CorridorsMs = Timer.Lap();
+}
+
+void FDungeonPipeline::FinishProps(const FDungeonGenParams& P, FDungeonLayout& Out, FDungeonGenStats* Stats)
+{
+	LLM_SCOPE_BYTAG(Dungeon_Generation);
+
+	FStageTimer Timer;
+	PopulateRooms(P, Out);
+	if (P.bCompactLayout) Out.Props.Shrink();
+	if (Stats) Stats->SampleMemory(Stats->PropsMem, Out.GetAllocatedSize());
+	if (Stats) Stats->PropsMs = Timer.Lap();
+}
+
+SIZE_T FDungeonPipeline::EstimatePeakBytes(const FDungeonGenParams& P, int32 NumRooms)
+{
+	const SIZE_T N = FMath::Max(0, NumRooms);
+	const SIZE_T M = FMath::Clamp(P.MainCount, 0, NumRooms);
+	constexpr SIZE_T SetOverhead = 2 * sizeof(int32); // chaînage + bucket de hash par élément d'un TSet
+
+	// Placement : salles de travail, plus tailles/étages et grille de cellules en Poisson
+	SIZE_T Place = N * sizeof(FRoomRef);
+	if (P.PlacementMode == EDungeonPlacementMode::PoissonDisk)
+		Place += N * (sizeof(FVector2D) + sizeof(int32) + sizeof(TPair<FIntVector, TArray<int32, TInlineAllocator<4>>>) + SetOverhead);
+
+	// Graphe : pic de Finish, salles du layout + graphe des main rooms (+ salles de travail hors mode compact)
+	SIZE_T Graph = N * sizeof(FDungeonRoomDesc) + (P.bCompactLayout ? 0 : N * sizeof(FRoomRef));
+	if (P.FloorCount > 1)
+	{
+		// ~6,5 tétraèdres et ~7,5 arêtes par point ; Bowyer–Watson garde 8 indices par tétraèdre en interne
+		Graph += M * (sizeof(FVector) + 7 * (8 * sizeof(int32) + sizeof(int32)) + 7 * sizeof(FDGTetra) + 8 * (sizeof(FDGEdge) + SetOverhead));
+	}
+	else
+	{
+		// ~2 triangles et ~3 arêtes par point
+		Graph += M * (sizeof(FVector2D) + 2 * sizeof(FDGTriangle) + 3 * (sizeof(FDGEdge) + SetOverhead));
+	}
+	Graph += M * (sizeof(FDGEdge) + 2 * sizeof(FCorridorSeg));
+
+	return FMath::Max(Place, Graph);
+}
+
+FVector2D FDungeonPipeline::RandomPointInDisk(float Radius, FRandomStream& Rng)
+{
+	const float Angle = Rng.FRandRange(0.f, 2.f * PI);
+	const float r = Radius * FMath::Sqrt(Rng.FRand());
+	return FVector2D(r * FMath::Cos(Angle), r * FMath::Sin(Angle));
+}
+
+void FDungeonPipeline::PlaceRooms(const FDungeonGenParams& P, FRandomStream& Rng, TArray<FRoomRef>& Out)
+{
+	Out.Reset();
+	Out.Reserve(P.RoomsNbr);
+	for (int32 i = 0; i < P.RoomsNbr; ++i)
+	{
+		const FVector2D Off2D = RandomPointInDisk(P.SpawnRadius, Rng);
+
+		const float SX = Rng.FRandRange(P.RoomSizeMin.X, P.RoomSizeMax.X);
+		const float SY = Rng.FRandRange(P.RoomSizeMin.Y, P.RoomSizeMax.Y);
+
+		FRoomRef R;
+		R.Center = Off2D;
+		R.Half   = FVector2D(SX, SY) * 0.5f;
+		if (P.FloorCount > 1) R.Floor = Rng.RandHelper(P.FloorCount);
+		Out.Add(R);
+	}
+}
+
+void FDungeonPipeline::PlaceRoomsPoisson(const FDungeonGenParams& P, FRandomStream& Rng, TArray<FRoomRef>& Out)
+{
+	Out.Reset();
+	if (P.RoomsNbr <= 0) return;
+	Out.Reserve(P.RoomsNbr);
+
+	const int32 Floors = FMath::Max(1, P.FloorCount);
+	TArray<FVector2D> Halves;
+	TArray<int32> RoomFloors;
+	Halves.Reserve(P.RoomsNbr);
+	RoomFloors.Reserve(P.RoomsNbr);
+	double TotalArea = 0.0;
+	for (int32 i = 0; i < P.RoomsNbr; ++i)
+	{
+		const float SX = Rng.FRandRange(P.RoomSizeMin.X, P.RoomSizeMax.X);
+		const float SY = Rng.FRandRange(P.RoomSizeMin.Y, P.RoomSizeMax.Y);
+		Halves.Add(FVector2D(SX, SY) * 0.5f);
+		RoomFloors.Add(Floors > 1 ? Rng.RandHelper(Floors) : 0);
+		TotalArea += static_cast<double>(SX) * SY;
+	}
+
+	// Disque assez grand pour contenir les salles d'un étage avec un taux de remplissage proche d'un layout relaxé
+	const double FillRatio = 0.55;
+	const double Limit = FMath::Max<double>(P.SpawnRadius, FMath::Sqrt(TotalArea / (Floors * PI * FillRatio)));
+
+	// Grille de cellule 2*MaxHalf : deux salles qui se chevauchent sont toujours dans des cellules voisines
+	const double MaxHalf = 0.5 * FMath::Max(FMath::Max(P.RoomSizeMin.X, P.RoomSizeMax.X), FMath::Max(P.RoomSizeMin.Y, P.RoomSizeMax.Y));
+	const double Cell = FMath::Max(1.0, 2.0 * MaxHalf);
+	TMap<FIntVector, TArray<int32, TInlineAllocator<4>>> Grid;
+	Grid.Reserve(P.RoomsNbr);
+
+	auto CellOf = [Cell](const FVector2D& C, int32 Floor)
+	{
+		return FIntVector(FMath::FloorToInt32(C.X / Cell), FMath::FloorToInt32(C.Y / Cell), Floor);
+	};
+	auto Fits = [&](const FVector2D& C, const FVector2D& H, int32 Floor)
+	{
+		const FIntVector K = CellOf(C, Floor);
+		for (int32 dy = -1; dy <= 1; ++dy)
+		for (int32 dx = -1; dx <= 1; ++dx)
+		{
+			const auto* Bucket = Grid.Find(K + FIntVector(dx, dy, 0));
+			if (!Bucket) continue;
+			for (int32 j : *Bucket)
+			{
+				const FRoomRef& O = Out[j];
+				if (FMath::Abs(C.X - O.Center.X) < H.X + O.Half.X &&
+				    FMath::Abs(C.Y - O.Center.Y) < H.Y + O.Half.Y) return false;
+			}
+		}
+		return true;
+	};
+
+	// Une liste active par étage : chaque étage pousse depuis le centre, les étages s'empilent sur le même disque
+	TArray<TArray<int32>> ActiveByFloor;
+	ActiveByFloor.SetNum(Floors);
+	TArray<bool> Seeded;
+	Seeded.Init(false, Floors);
+
+	// Un point qui rate une grande salle peut encore en accueillir une petite : il n'est retiré qu'après
+	// MaxPointFailures salles ratées, ou tout de suite s'il rate la plus petite taille tirée.
+	constexpr int32 MaxPointFailures = 4;
+	TArray<uint8> Failures; // par salle de Out
+	Failures.Reserve(P.RoomsNbr);
+	FVector2D MinHalf(DBL_MAX, DBL_MAX);
+	for (const FVector2D& H : Halves) MinHalf = FVector2D::Min(MinHalf, H);
+
+	auto Insert = [&](const FVector2D& C, const FVector2D& H, int32 Floor)
+	{
+		FRoomRef R;
+		R.Center = C;
+		R.Half   = H;
+		R.Floor  = Floor;
+		const int32 Idx = Out.Add(R);
+		Failures.Add(0);
+		Grid.FindOrAdd(CellOf(C, Floor)).Add(Idx);
+		ActiveByFloor[Floor].Add(Idx);
+	};
+
+	for (int32 i = 0; i < Halves.Num(); ++i)
+	{
+		const FVector2D H = Halves[i];
+		const int32 F = RoomFloors[i];
+		TArray<int32>& Active = ActiveByFloor[F];
+
+		if (!Seeded[F])
+		{
+			Insert(FVector2D::ZeroVector, H, F);
+			Seeded[F] = true;
+			continue;
+		}
+
+		// Chaque point actif est essayé au plus une fois par salle : Active[0, Untried) reste à essayer
+		const bool bSmallest = H.X <= MinHalf.X && H.Y <= MinHalf.Y;
+		int32 Untried = Active.Num();
+		bool placed = false;
+		while (!placed && Untried > 0)
+		{
+			const int32 ai = Rng.RandHelper(Untried);
+			const FRoomRef A = Out[Active[ai]];
+
+			for (int32 k = 0; k < P.PoissonCandidates && !placed; ++k)
+			{
+				// Distance minimale pour que les deux boîtes se touchent dans cette direction, puis un anneau [t0, 1.25 t0]
+				const float Angle = Rng.FRandRange(0.f, 2.f * PI);
+				const FVector2D Dir(FMath::Cos(Angle), FMath::Sin(Angle));
+				const double tx = FMath::Abs(Dir.X) > UE_KINDA_SMALL_NUMBER ? (A.Half.X + H.X) / FMath::Abs(Dir.X) : DBL_MAX;
+				const double ty = FMath::Abs(Dir.Y) > UE_KINDA_SMALL_NUMBER ? (A.Half.Y + H.Y) / FMath::Abs(Dir.Y) : DBL_MAX;
+				const double t  = FMath::Min(tx, ty) * Rng.FRandRange(1.f, 1.25f);
+
+				const FVector2D C = A.Center + Dir * t;
+				if (C.SizeSquared() > Limit * Limit || !Fits(C, H, F)) continue;
+
+				Insert(C, H, F);
+				placed = true;
+			}
+			if (placed) break;
+
+			--Untried;
+			Active.Swap(ai, Untried);
+			if (bSmallest || ++Failures[Active[Untried]] >= MaxPointFailures) Active.RemoveAtSwap(Untried);
+		}
+
+		// Disque saturé : placement uniforme, la relaxation s'en charge
+		if (!placed) Insert(RandomPointInDisk(Limit, Rng), H, F);
+	}
+}
+
+bool FDungeonPipeline::Overlap(const FRoomRef& A, const FRoomRef& B, float Padding)
+{
+	// Une salle occupe exactement un étage : deux boîtes d'étages différents ne se touchent jamais
+	if (A.Floor != B.Floor) return false;
+	const FVector2D d = (A.Center - B.Center).GetAbs();
+	return (d.X < (A.Half.X + B.Half.X - Padding)) && (d.Y < (A.Half.Y + B.Half.Y - Padding));
+}
+
+FVector2D FDungeonPipeline::MTV(const FRoomRef& A, const FRoomRef& B)
+{
+	const FVector2D d = B.Center - A.Center;
+	const float ox = (A.Half.X + B.Half.X) - FMath::Abs(d.X);
+	const float oy = (A.Half.Y + B.Half.Y) - FMath::Abs(d.Y);
+	if (ox < oy)
+	{
+		const float sx = (d.X >= 0.f) ? 1.f : -1.f;
+		return FVector2D(ox * sx, 0.f);
+	}
+	else
+	{
+		const float sy = (d.Y >= 0.f) ? 1.f : -1.f;
+		return FVector2D(0.f, oy * sy);
+	}
+}
+
+int32 FDungeonPipeline::RelaxOnce(const FDungeonGenParams& P, TArray<FRoomRef>& Refs)
+{
+	int32 overlaps = 0;
+	for (int32 i = 0; i < Refs.Num(); ++i)
+	{
+		for (int32 j = i + 1; j < Refs.Num(); ++j)
+		{
+			if (Overlap(Refs[i], Refs[j], P.ContactPadding))
+			{
+				overlaps++;
+				FVector2D mtv = MTV(Refs[i], Refs[j]);
+				mtv.X = FMath::Clamp(mtv.X, -P.NudgeClamp, P.NudgeClamp);
+				mtv.Y = FMath::Clamp(mtv.Y, -P.NudgeClamp, P.NudgeClamp);
+				Refs[i].Center -= mtv * 0.5f;
+				Refs[j].Center += mtv * 0.5f;
+			}
+		}
+	}
+	return overlaps;
+}
+
+int32 FDungeonPipeline::RelaxOnceFloors(const FDungeonGenParams& P, TArray<FRoomRef>& Refs)
+{
+	// Grille par étage de cellule 2*MaxHalf, comme le placement Poisson : deux salles qui se chevauchent sont toujours
+	// dans des cellules voisines. Elle suit les déplacements pendant la passe, donc aucune paire n'est manquée
+	// comme avec un ordre de tri calculé avant que les salles bougent.
+	double MaxHalf = 1.0;
+	for (const FRoomRef& R : Refs) MaxHalf = FMath::Max(MaxHalf, FMath::Max(R.Half.X, R.Half.Y));
+	const double Cell = 2.0 * MaxHalf;
+
+	auto CellOf = [Cell](const FRoomRef& R)
+	{
+		return FIntVector(FMath::FloorToInt32(R.Center.X / Cell), FMath::FloorToInt32(R.Center.Y / Cell), R.Floor);
+	};
+
+	TMap<FIntVector, TArray<int32, TInlineAllocator<4>>> Grid;
+	Grid.Reserve(Refs.Num());
+	for (int32 i = 0; i < Refs.Num(); ++i) Grid.FindOrAdd(CellOf(Refs[i])).Add(i);
+
+	auto Gather = [&Grid](const FIntVector& K, TArray<int32, TInlineAllocator<32>>& Out)
+	{
+		Out.Reset();
+		for (int32 dy = -1; dy <= 1; ++dy)
+		for (int32 dx = -1; dx <= 1; ++dx)
+			if (const auto* Bucket = Grid.Find(K + FIntVector(dx, dy, 0))) Out.Append(*Bucket);
+	};
+	auto Rebucket = [&](int32 i, const FIntVector& Old)
+	{
+		const FIntVector New = CellOf(Refs[i]);
+		if (New == Old) return;
+		if (auto* Bucket = Grid.Find(Old)) Bucket->RemoveSingleSwap(i);
+		Grid.FindOrAdd(New).Add(i);
+	};
+
+	// La salle i tient-elle sur l'étage Floor sans toucher personne ?
+	TArray<int32, TInlineAllocator<32>> Others;
+	auto IsFree = [&](int32 i, int32 Floor)
+	{
+		FRoomRef Probe = Refs[i];
+		Probe.Floor = Floor;
+		Gather(CellOf(Probe), Others);
+		for (int32 j : Others)
+			if (j != i && Overlap(Probe, Refs[j], P.ContactPadding)) return false;
+		return true;
+	};
+
+	int32 overlaps = 0;
+	TArray<int32, TInlineAllocator<32>> Near;
+	for (int32 a = 0; a < Refs.Num(); ++a)
+	{
+		// Copie : les déplacements de la boucle modifient les cases
+		Gather(CellOf(Refs[a]), Near);
+		for (int32 b : Near)
+		{
+			if (b <= a) continue;
+			FRoomRef& A = Refs[a];
+			FRoomRef& B = Refs[b];
+			if (!Overlap(A, B, P.ContactPadding)) continue;
+
+			overlaps++;
+			FVector2D mtv = MTV(A, B);
+
+			// MTV 3D : l'axe vertical coûte un étage entier ; s'il est plus court, la plus petite salle change d'étage,
+			// seulement si sa place y est libre (sinon deux étages pleins se la renvoient à chaque passe)
+			if (P.FloorCount > 1 && FMath::Max(FMath::Abs(mtv.X), FMath::Abs(mtv.Y)) > P.FloorHeight)
+			{
+				const int32 s = (A.Area() <= B.Area()) ? a : b;
+				const int32 From = Refs[s].Floor;
+				int32 To = INDEX_NONE;
+				if (From + 1 < P.FloorCount && IsFree(s, From + 1)) To = From + 1;
+				else if (From > 0 && IsFree(s, From - 1)) To = From - 1;
+
+				if (To != INDEX_NONE)
+				{
+					const FIntVector Old = CellOf(Refs[s]);
+					Refs[s].Floor = To;
+					Rebucket(s, Old);
+					if (s == a) break; // a a quitté l'étage : ses voisins gardés ne sont plus les siens
+					continue;
+				}
+			}
+
+			const FIntVector OldA = CellOf(A), OldB = CellOf(B);
+			mtv.X = FMath::Clamp(mtv.X, -P.NudgeClamp, P.NudgeClamp);
+			mtv.Y = FMath::Clamp(mtv.Y, -P.NudgeClamp, P.NudgeClamp);
+			A.Center -= mtv * 0.5f;
+			B.Center += mtv * 0.5f;
+			Rebucket(a, OldA);
+			Rebucket(b, OldB);
+		}
+	}
+	return overlaps;
+}
+
+int32 FDungeonPipeline::CullResidualOverlaps(const FDungeonGenParams& P, TArray<FRoomRef>& Refs)
+{
+	if (!P.bEnableCulling || P.MaxCulls <= 0) return 0;
+
+	int32 culls = 0;
+	bool changed = true;
+
+	while (changed && culls < P.MaxCulls)
+	{
+		changed = false;
+		for (int32 i = 0; i < Refs.Num(); ++i)
+		{
+			for (int32 j = i + 1; j < Refs.Num(); ++j)
+			{
+				if (Overlap(Refs[i], Refs[j], P.ContactPadding))
+				{
+					const FVector2D mtv = MTV(Refs[i], Refs[j]);
+					const float pen = FMath::Max(FMath::Abs(mtv.X), FMath::Abs(mtv.Y));
+
+					if (pen > P.CullPenetrationThreshold)
+					{
+						const int32 kill = (Refs[i].Area() <= Refs[j].Area()) ? i : j;
+						Refs.RemoveAt(kill);
+						++culls; changed = true; break;
+					}
+				}
+			}
+			if (changed) break;
+		}
+	}
+	return culls;
+}
+
+bool FDungeonPipeline::TooCloseAABB(const FRoomRef& A, const FRoomRef& B, float ExtraGap)
+{
+	const FVector2D HA = A.Half + FVector2D(ExtraGap, ExtraGap);
+	const FVector2D HB = B.Half + FVector2D(ExtraGap, ExtraGap);
+
+	const FVector2D d = (A.Center - B.Center).GetAbs();
+	return (d.X < (HA.X + HB.X)) && (d.Y < (HA.Y + HB.Y));
+}
+
+void FDungeonPipeline::SelectMainRooms(const FDungeonGenParams& P, TArray<FRoomRef>& Refs)
+{
+	for (FRoomRef& R : Refs) R.bIsMain = false;
+
+	TArray<int32> Sorted;
+	Sorted.Reserve(Refs.Num());
+	for (int32 i = 0; i < Refs.Num(); ++i) Sorted.Add(i);
+	Sorted.Sort([&Refs](int32 A, int32 B){ return Refs[A].ClampedArea() > Refs[B].ClampedArea(); });
+
+	TArray<int32> Picked; Picked.Reserve(P.MainCount);
+	for (int32 Candidate : Sorted)
+	{
+		if (Picked.Num() >= P.MainCount) break;
+		bool ok = true;
+		for (int32 Pk : Picked) if (TooCloseAABB(Refs[Candidate], Refs[Pk], P.MinMainGap)) { ok = false; break; }
+		if (ok) Picked.Add(Candidate);
+	}
+
+	RelaxMainRoomsPositions(P, Refs, Picked);
+
+	for (int32 i : Picked) Refs[i].bIsMain = true;
+}
+
+void FDungeonPipeline::RelaxMainRoomsPositions(const FDungeonGenParams& P, TArray<FRoomRef>& Refs, const TArray<int32>& Mains)
+{
+	for (int32 it = 0; it < 10; ++it)
+	{
+		bool moved = false;
+		for (int32 i = 0; i < Mains.Num(); ++i)
+		{
+			for (int32 j = i + 1; j < Mains.Num(); ++j)
+			{
+				FRoomRef& A = Refs[Mains[i]];
+				FRoomRef& B = Refs[Mains[j]];
+				if (!TooCloseAABB(A, B, P.MinMainGap)) continue;
+
+				const FVector2D push = (B.Center - A.Center).GetSafeNormal() * 40.f;
+				A.Center -= push;
+				B.Center += push;
+				moved = true;
+			}
+		}
+		if (!moved) break;
+	}
+}
+
+void FDungeonPipeline::SnapToLayoutGrid(TArray<FRoomRef>& Refs)
+{
+	// Tout l'aval travaille sur les valeurs quantifiées : un client reconstruit alors exactement les mêmes couloirs
+	for (FRoomRef& R : Refs)
+	{
+		R.Center = FDungeonLayout::Quantize(R.Center);
+		R.Half   = FDungeonLayout::Quantize(R.Half * 2.f) * 0.5f;
+	}
+	Algo::StableSort(Refs, [](const FRoomRef& A, const FRoomRef& B)
+	{
+		return (A.Center.X != B.Center.X) ? A.Center.X < B.Center.X : A.Center.Y < B.Center.Y;
+	});
+}
+
+void FDungeonPipeline::SeparateClusterDisks(TArray<FVector2D>& Offsets, const TArray<double>& Radii)
+{
+	const int32 N = Offsets.Num();
+	auto Overlapping = [&Offsets, &Radii, N]()
+	{
+		for (int32 i = 0; i < N; ++i)
+			for (int32 j = i + 1; j < N; ++j)
+				if (FVector2D::Distance(Offsets[i], Offsets[j]) < Radii[i] + Radii[j]) return true;
+		return false;
+	};
+
+	// Chaque paire qui se chevauche s'écarte à parts égales, de quoi juste se toucher
+	for (int32 it = 0; it < 512; ++it)
+	{
+		bool bMoved = false;
+		for (int32 i = 0; i < N; ++i)
+		{
+			for (int32 j = i + 1; j < N; ++j)
+			{
+				const FVector2D D = Offsets[j] - Offsets[i];
+				const double Dist = D.Size();
+				const double Need = Radii[i] + Radii[j];
+				if (Dist >= Need) continue;
+				// Centres confondus : direction propre à la paire, pour rester déterministe
+				const FVector2D Dir = (Dist > UE_KINDA_SMALL_NUMBER) ? D / Dist : FVector2D(FMath::Cos(double(i + j)), FMath::Sin(double(i + j)));
+				const double Push = (Need - Dist) * 0.5 + 1.0;
+				Offsets[i] -= Dir * Push;
+				Offsets[j] += Dir * Push;
+				bMoved = true;
+			}
+		}
+		if (!bMoved) return;
+	}
+
+	// Pas de convergence : les groupes en ligne, jamais superposés
+	if (!Overlapping()) return;
+	double X = 0.0;
+	for (int32 i = 0; i < N; ++i)
+	{
+		X += (i > 0) ? Radii[i - 1] + Radii[i] : 0.0;
+		Offsets[i] = FVector2D(X, 0.0);
+	}
+}
+
+void FDungeonPipeline::CopyRoomsToLayout(const TArray<FRoomRef>& Refs, FDungeonLayout& Out)
+{
+	Out.Rooms.Reset();
+	Out.Rooms.Reserve(Refs.Num());
+	for (const FRoomRef& R : Refs)
+	{
+		FDungeonRoomDesc& D = Out.Rooms.AddDefaulted_GetRef();
+		D.Center  = R.Center;
+		D.Size    = R.Half * 2.f;
+		D.Floor   = R.Floor;
+		D.bIsMain = R.bIsMain;
+	}
+}
+
+template<typename Kernel>
+void FDungeonPipeline::BuildDelaunay(const TArray<typename Kernel::FVec>& Points, TArray<FDGTriangle>& Out)
+{
+	using FVec = typename Kernel::FVec;
+	using FScalar = typename Kernel::FScalar;
+
+	Out.Reset();
+	if (Points.Num() < 3) return;
+
+	UE::Math::TBox2<FScalar> BB(Points[0], Points[0]); for (const auto& P : Points) BB += P;
+	const FScalar delta = FMath::Max(BB.Max.X - BB.Min.X, BB.Max.Y - BB.Min.Y) * 10;
+	const FVec mid = (BB.Min + BB.Max) * FScalar(0.5);
+
+	const FVec S1(mid.X - 2*delta, mid.Y - delta);
+	const FVec S2(mid.X,            mid.Y + 2*delta);
+	const FVec S3(mid.X + 2*delta,  mid.Y - delta);
+
+	TArray<FVec> Pts = Points;
+	const int32 iS1 = Pts.Add(S1), iS2 = Pts.Add(S2), iS3 = Pts.Add(S3);
+
+	TArray<FDGTriangle> Tris;
+	Tris.Add(FDGTriangle(iS1, iS2, iS3));
+
+	for (int32 idx = 0; idx < Points.Num(); ++idx)
+	{
+		const FVec& P = Points[idx];
+
+		TArray<int32> Bad;
+		for (int32 t = 0; t < Tris.Num(); ++t)
+		{
+			const FDGTriangle& T = Tris[t];
+			if (Kernel::InCircumcircle(P, Pts[T.I], Pts[T.J], Pts[T.K])) Bad.Add(t);
+		}
+
+		TMap<FDGEdge, int32> EdgeCount;
+		for (int32 tIndex : Bad)
+		{
+			const FDGTriangle& T = Tris[tIndex];
+			EdgeCount.FindOrAdd(FDGEdge(T.I,T.J))++;
+			EdgeCount.FindOrAdd(FDGEdge(T.J,T.K))++;
+			EdgeCount.FindOrAdd(FDGEdge(T.K,T.I))++;
+		}
+
+		Bad.Sort();
+		for (int32 i = Bad.Num()-1; i >= 0; --i) Tris.RemoveAt(Bad[i]);
+
+		for (const auto& KV : EdgeCount)
+			if (KV.Value == 1) Tris.Add(FDGTriangle(KV.Key.A, KV.Key.B, idx));
+	}
+
+	for (int32 i = Tris.Num()-1; i >= 0; --i)
+	{
+		const FDGTriangle& T = Tris[i];
+		if (T.I >= Points.Num() || T.J >= Points.Num() || T.K >= Points.Num())
+			Tris.RemoveAt(i);
+	}
+
+	Out = MoveTemp(Tris);
+}
+
+template void FDungeonPipeline::BuildDelaunay<TDungeonKernel<float,  2, FDungeonFastPredicates>>(const TArray<FVector2f>&, TArray<FDGTriangle>&);
+template void FDungeonPipeline::BuildDelaunay<TDungeonKernel<double, 2, FDungeonFastPredicates>>(const TArray<FVector2D>&, TArray<FDGTriangle>&);
+template void FDungeonPipeline::BuildDelaunay<TDungeonKernel<float,  2, FDungeonExactPredicates>>(const TArray<FVector2f>&, TArray<FDGTriangle>&);
+template void FDungeonPipeline::BuildDelaunay<TDungeonKernel<double, 2, FDungeonExactPredicates>>(const TArray<FVector2D>&, TArray<FDGTriangle>&);
+
+void FDungeonPipeline::BuildDelaunay(const TArray<FVector2D>& Points, TArray<FDGTriangle>& Out)
+{
+	BuildDelaunay<FDungeonKernel2D>(Points, Out);
+}
+
+void FDungeonPipeline::EdgesFromTriangles(const TArray<FDGTriangle>& Tris, TSet<FDGEdge>& Out)
+{
+	Out.Reset();
+	for (const FDGTriangle& T : Tris)
+	{
+		Out.Add(FDGEdge(T.I, T.J));
+		Out.Add(FDGEdge(T.J, T.K));
+		Out.Add(FDGEdge(T.K, T.I));
+	}
+}
+
+void FDungeonPipeline::BuildMST_Prim(const TArray<FVector2D>& Points, const TSet<FDGEdge>& Edges, TArray<FDGEdge>& Out)
+{
+	Out.Reset();
+	const int32 N = Points.Num();
+	if (N <= 1) return;
+
+	TSet<int32> Visited; Visited.Add(0);
+
+	while (Visited.Num() < N)
+	{
+		float Best = TNumericLimits<float>::Max();
+		FDGEdge BestE; int32 Next = INDEX_NONE;
+
+		for (const FDGEdge& E : Edges)
+		{
+			const bool aIn = Visited.Contains(E.A);
+			const bool bIn = Visited.Contains(E.B);
+			if (aIn == bIn) continue;
+
+			const float d = (Points[E.A] - Points[E.B]).Size();
+			if (d < Best) { Best = d; BestE = E; Next = aIn ? E.B : E.A; }
+		}
+
+		if (Next == INDEX_NONE) break;
+		Out.Add(BestE);
+		Visited.Add(Next);
+	}
+}
+
+void FDungeonPipeline::BuildMST_Kruskal(const TArray<FVector>& Points, const TSet<FDGEdge>& Edges, TArray<FDGEdge>& Out)
+{
+	Out.Reset();
+	const int32 N = Points.Num();
+	if (N <= 1) return;
+
+	// Tri des arêtes + union-find : O(E log E), là où Prim ci-dessus est en O(N.E)
+	TArray<TPair<double, FDGEdge>> Sorted;
+	Sorted.Reserve(Edges.Num());
+	for (const FDGEdge& E : Edges) Sorted.Emplace(FVector::DistSquared(Points[E.A], Points[E.B]), E);
+	Algo::Sort(Sorted, [](const TPair<double, FDGEdge>& L, const TPair<double, FDGEdge>& R)
+	{
+		if (L.Key != R.Key) return L.Key < R.Key;
+		return (L.Value.A != R.Value.A) ? L.Value.A < R.Value.A : L.Value.B < R.Value.B;
+	});
+
+	TArray<int32> Parent;
+	Parent.SetNumUninitialized(N);
+	for (int32 i = 0; i < N; ++i) Parent[i] = i;
+	auto Find = [&Parent](int32 X)
+	{
+		while (Parent[X] != X) { Parent[X] = Parent[Parent[X]]; X = Parent[X]; }
+		return X;
+	};
+
+	Out.Reserve(N - 1);
+	for (const TPair<double, FDGEdge>& It : Sorted)
+	{
+		const int32 RA = Find(It.Value.A);
+		const int32 RB = Find(It.Value.B);
+		if (RA == RB) continue;
+		Parent[RA] = RB;
+		Out.Add(It.Value);
+		if (Out.Num() == N - 1) break;
+	}
+}
+
+void FDungeonPipeline::MainRoomCenters(const FDungeonLayout& Layout, TArray<FVector2D>& OutPoints, TArray<int32>* OutRoomIndices)
+{
+	OutPoints.Reset();
+	if (OutRoomIndices) OutRoomIndices->Reset();
+	for (int32 i = 0; i < Layout.Rooms.Num(); ++i)
+	{
+		if (!Layout.Rooms[i].bIsMain) continue;
+		OutPoints.Add(Layout.Rooms[i].Center);
+		if (OutRoomIndices) OutRoomIndices->Add(i);
+	}
+}
+
+void FDungeonPipeline::MainRoomCenters3D(const FDungeonLayout& Layout, float FloorHeight, TArray<FVector>& OutPoints, TArray<int32>* OutRoomIndices)
+{
+	OutPoints.Reset();
+	if (OutRoomIndices) OutRoomIndices->Reset();
+	for (int32 i = 0; i < Layout.Rooms.Num(); ++i)
+	{
+		const FDungeonRoomDesc& R = Layout.Rooms[i];
+		if (!R.bIsMain) continue;
+		OutPoints.Add(FVector(R.Center.X, R.Center.Y, R.Floor * FloorHeight));
+		if (OutRoomIndices) OutRoomIndices->Add(i);
+	}
+}
+
+template<EDungeonCorridorStyle Style>
+void FDungeonPipeline::BuildCorridor(const FDungeonGenParams& P, const FDungeonRoomDesc& AR, const FDungeonRoomDesc& BR, TArray<FCorridorSeg>& Out)
+{
+    auto ExitPointFromRoom = [](const FVector2D& Start, const FVector2D& Toward,
+                                const FDungeonRoomDesc& Room, float Inset)
+    {
+        FVector2D H = Room.Size * 0.5f;
+        H.X = FMath::Max(0.f, H.X - Inset);
+        H.Y = FMath::Max(0.f, H.Y - Inset);
+        return FDungeonKernel2D::ExitPoint(Start, Toward, Room.Center, H);
+    };
+
+    const float EdgeInset = 10.f;
+    const float EpsAlign  = 1e-2f;
+
+    const FVector2D Acenter = AR.Center;
+    const FVector2D Bcenter = BR.Center;
+    const float ZA = AR.Floor * P.FloorHeight;
+    const float ZB = BR.Floor * P.FloorHeight;
+
+    const FVector2D Aedge = ExitPointFromRoom(Acenter, Bcenter, AR, EdgeInset);
+    const FVector2D Bedge = ExitPointFromRoom(Bcenter, Acenter, BR, EdgeInset);
+
+    if constexpr (Style == EDungeonCorridorStyle::Straight)
+    {
+        Out.Emplace(Aedge, Bedge, ZA, ZB);
+    }
+    else
+    {
+        const bool AlignedH = FMath::IsNearlyEqual(Acenter.Y, Bcenter.Y, EpsAlign);
+        const bool AlignedV = FMath::IsNearlyEqual(Acenter.X, Bcenter.X, EpsAlign);
+
+        if (AlignedH || AlignedV)
+        {
+            Out.Emplace(Aedge, Bedge, ZA, ZB);
+        }
+        else
+        {
+            FVector2D Corner(Acenter.X, Bcenter.Y);
+            const FVector2D A_to_Corner = ExitPointFromRoom(Acenter, Corner, AR, EdgeInset);
+            const FVector2D Corner_to_B = ExitPointFromRoom(Bcenter, Corner, BR, EdgeInset);
+
+            // Entre deux étages, la montée se fait sur la plus longue des deux branches du L (pente la plus douce)
+            const bool bRampFirst = (Corner - A_to_Corner).SizeSquared() >= (Corner_to_B - Corner).SizeSquared();
+            const float ZCorner = bRampFirst ? ZB : ZA;
+
+            Out.Emplace(A_to_Corner, Corner, ZA, ZCorner);
+            Out.Emplace(Corner, Corner_to_B, ZCorner, ZB);
+        }
+    }
+}
+
+template<EDungeonCorridorStyle Style>
+void FDungeonPipeline::BuildCorridors(const FDungeonGenParams& P, FDungeonLayout& Layout)
+{
+    Layout.Corridors.Reset();
+
+    TArray<int32> MainRoom;
+    TArray<FVector2D> Points;
+    MainRoomCenters(Layout, Points, &MainRoom);
+
+    for (const FDGEdge& E : Layout.MSTEdges)
+        BuildCorridor<Style>(P, Layout.Rooms[MainRoom[E.A]], Layout.Rooms[MainRoom[E.B]], Layout.Corridors);
+}
+
+template void FDungeonPipeline::BuildCorridors<EDungeonCorridorStyle::LShape>(const FDungeonGenParams&, FDungeonLayout&);
+template void FDungeonPipeline::BuildCorridors<EDungeonCorridorStyle::Straight>(const FDungeonGenParams&, FDungeonLayout&);
+
+void FDungeonPipeline::BuildCorridors(const FDungeonGenParams& P, FDungeonLayout& Layout)
+{
+    // Le style est résolu une fois ici, jamais dans la boucle sur les arêtes
+    if (P.bCorridorFollowMSTExact) BuildCorridors<EDungeonCorridorStyle::Straight>(P, Layout);
+    else                           BuildCorridors<EDungeonCorridorStyle::LShape>(P, Layout);
+}
+
+void FDungeonPipeline::BuildCorridor(const FDungeonGenParams& P, const FDungeonRoomDesc& A, const FDungeonRoomDesc& B, TArray<FCorridorSeg>& Out)
+{
+    if (P.bCorridorFollowMSTExact) BuildCorridor<EDungeonCorridorStyle::Straight>(P, A, B, Out);
+    else                           BuildCorridor<EDungeonCorridorStyle::LShape>(P, A, B, Out);
+}
+
+void FDungeonPipeline::KeepMainAndCorridorRooms(const FDungeonGenParams& P, FDungeonLayout& Layout)
+{
+	if (!P.bKeepOnlyMainAndPath) return;
+
+	// Les main rooms sont toujours gardées et leur ordre relatif ne change pas : les indices du MST restent valides
+	Layout.Rooms.RemoveAll([&](const FDungeonRoomDesc& R)
+	{
+		if (R.bIsMain) return false;
+
+		FVector2D Half(R.Size.X * 0.5f, R.Size.Y * 0.5f);
+		Half.X += P.CorridorKeepDistance;
+		Half.Y += P.CorridorKeepDistance;
+		const float RoomZ = R.Floor * P.FloorHeight;
+
+		for (const FCorridorSeg& S : Layout.Corridors)
+		{
+			// Un couloir ne garde que les salles des étages qu'il traverse
+			if (RoomZ < FMath::Min(S.ZA, S.ZB) - 0.5f * P.FloorHeight || RoomZ > FMath::Max(S.ZA, S.ZB) + 0.5f * P.FloorHeight) continue;
+			if (FDungeonKernel2D::SegmentIntersectsBox(S.A, S.B, R.Center, Half)) return false;
+		}
+		return true;
+	});
+}
+
+FIntPoint FDungeonSegmentGrid::CellOf(const FVector2D& P)
+{
+	return FIntPoint(FMath::FloorToInt32(P.X / CellSize), FMath::FloorToInt32(P.Y / CellSize));
+}
+
+void FDungeonSegmentGrid::Build(const TArray<FCorridorSeg>& Segments)
+{
+	Cells.Reset();
+	for (int32 i = 0; i < Segments.Num(); ++i) Add(i, Segments[i]);
+}
+
+void FDungeonSegmentGrid::Add(int32 Segment, const FCorridorSeg& S)
+{
+	if (S.A == S.B) return;
+	const FIntPoint Lo = CellOf(FVector2D::Min(S.A, S.B));
+	const FIntPoint Hi = CellOf(FVector2D::Max(S.A, S.B));
+	for (int32 y = Lo.Y; y <= Hi.Y; ++y)
+		for (int32 x = Lo.X; x <= Hi.X; ++x)
+			Cells.FindOrAdd(FIntPoint(x, y)).Add(Segment);
+}
+
+void FDungeonSegmentGrid::Remove(int32 Segment, const FCorridorSeg& S)
+{
+	if (S.A == S.B) return;
+	const FIntPoint Lo = CellOf(FVector2D::Min(S.A, S.B));
+	const FIntPoint Hi = CellOf(FVector2D::Max(S.A, S.B));
+	for (int32 y = Lo.Y; y <= Hi.Y; ++y)
+		for (int32 x = Lo.X; x <= Hi.X; ++x)
+			if (TArray<int32>* Bucket = Cells.Find(FIntPoint(x, y))) Bucket->RemoveSingleSwap(Segment, EAllowShrinking::No);
+}
+
+void FDungeonSegmentGrid::Query(const FVector2D& Min, const FVector2D& Max, TArray<int32, TInlineAllocator<16>>& Out) const
+{
+	Out.Reset();
+	const FIntPoint Lo = CellOf(Min);
+	const FIntPoint Hi = CellOf(Max);
+	for (int32 y = Lo.Y; y <= Hi.Y; ++y)
+		for (int32 x = Lo.X; x <= Hi.X; ++x)
+			if (const TArray<int32>* Bucket = Cells.Find(FIntPoint(x, y))) Out.Append(*Bucket);
+
+	// Un segment long est dans plusieurs cases
+	Algo::Sort(Out);
+	Out.SetNum(Algo::Unique(Out));
+}
+
+bool FDungeonPipeline::ClipCorridorToRoom(const FDungeonGenParams& P, const FDungeonRoomDesc& Room, const FCorridorSeg& S, FVector2D& OutA, FVector2D& OutB)
+{
+	if (S.A == S.B) return false;
+	const float RoomZ = Room.Floor * P.FloorHeight;
+	if (RoomZ < FMath::Min(S.ZA, S.ZB) - 0.5f * P.FloorHeight || RoomZ > FMath::Max(S.ZA, S.ZB) + 0.5f * P.FloorHeight) return false;
+
+	const FVector2D Reach = Room.Size * 0.5 + FVector2D(P.Props.CorridorClearance);
+	double u0, u1;
+	if (!FDungeonKernel2D::ClipSegment(S.A, S.B, Room.Center, Reach, u0, u1)) return false;
+	OutA = S.A + (S.B - S.A) * u0;
+	OutB = S.A + (S.B - S.A) * u1;
+	return true;
+}
+
+void FDungeonPipeline::PopulateRooms(const FDungeonGenParams& P, FDungeonLayout& Layout)
+{
+	Layout.Props.Reset();
+	if (!P.Props.IsEnabled() || Layout.Rooms.Num() == 0) return;
+
+	TArray<TArray<FDungeonProp>> PerRoom;
+	PerRoom.SetNum(Layout.Rooms.Num());
+
+	// Grille construite une fois : chaque salle ne découpe que les segments proches (O(salles) au lieu de salles x segments)
+	FDungeonSegmentGrid Grid;
+	Grid.Build(Layout.Corridors);
+
+	ParallelFor(TEXT("DungeonPopulateRooms"), Layout.Rooms.Num(), 16, [&](int32 RoomIndex)
+	{
+		PopulateRoom(P, Layout.Seed, Layout.Rooms[RoomIndex], Layout.Corridors, Grid, PerRoom[RoomIndex]);
+	});
+
+	// Concaténation dans l'ordre des salles : déterministe
+	int32 Total = 0;
+	for (const TArray<FDungeonProp>& Props : PerRoom) Total += Props.Num();
+	Layout.Props.Reserve(Total);
+	for (TArray<FDungeonProp>& Props : PerRoom) Layout.Props.Append(MoveTemp(Props));
+}
+
+void FDungeonPipeline::PopulateRoom(const FDungeonGenParams& P, int32 Seed, const FDungeonRoomDesc& Room, const TArray<FCorridorSeg>& Corridors,
+	const FDungeonSegmentGrid& Grid, TArray<FDungeonProp>& Out)
+{
+	Out.Reset();
+	const FDungeonPropRules& Rules = P.Props;
+	if (!Rules.IsEnabled()) return;
+
+	// Tirage pondéré sur les sommes cumulées ; une salle secondaire ignore les props réservés aux main rooms
+	TArray<float, TInlineAllocator<16>> Cum;
+	float Sum = 0.f;
+	for (const FDungeonPropRule& R : Rules.Rules)
+	{
+		if (Room.bIsMain || !R.bMainRoomsOnly) Sum += R.Weight;
+		Cum.Add(Sum);
+	}
+	if (Sum <= 0.f) return;
+
+	// Seed de la salle : seed du donjon + centre quantifié et étage, indépendante de l'ordre des salles
+	const uint32 RoomHash = HashCombine(HashCombine(GetTypeHash(Seed), GetTypeHash(FDungeonLayout::Quantize(Room.Center))), GetTypeHash(Room.Floor));
+	FRandomStream Rng(static_cast<int32>(RoomHash));
+
+	const FVector2D Half = Room.Size * 0.5;
+
+	// Couloirs qui touchent la salle : entrée, sortie et trajet à l'intérieur restent dégagés
+	TArray<TPair<FVector2D, FVector2D>, TInlineAllocator<8>> Clear;
+	const FVector2D Reach = Half + FVector2D(Rules.CorridorClearance);
+	TArray<int32, TInlineAllocator<16>> Near;
+	Grid.Query(Room.Center - Reach, Room.Center + Reach, Near);
+	for (int32 s : Near)
+	{
+		FVector2D A, B;
+		if (ClipCorridorToRoom(P, Room, Corridors[s], A, B)) Clear.Emplace(A, B);
+	}
+
+	const double AreaM2 = Room.Size.X * Room.Size.Y / 10000.0;
+	const int32 Target = FMath::Min(Rules.MaxPerRoom, FMath::RoundToInt32(AreaM2 * Rules.DensityPerSquareMeter));
+
+	Out.Reserve(Target);
+	for (int32 n = 0; n < Target; ++n)
+	{
+		const float Pick = Rng.FRandRange(0.f, Sum);
+		int32 RuleIndex = Algo::UpperBound(Cum, Pick);
+		RuleIndex = FMath::Min(RuleIndex, Rules.Rules.Num() - 1);
+		const FDungeonPropRule& R = Rules.Rules[RuleIndex];
+
+		const FVector2D Free = Half - FVector2D(Rules.WallMargin + R.Radius);
+		if (Free.X < 0.0 || Free.Y < 0.0) continue;
+
+		for (int32 Attempt = 0; Attempt < Rules.MaxAttemptsPerProp; ++Attempt)
+		{
+			const FVector2D Pos = Room.Center + FVector2D(Rng.FRandRange(-Free.X, Free.X), Rng.FRandRange(-Free.Y, Free.Y));
+
+			bool bBlocked = false;
+			for (const TPair<FVector2D, FVector2D>& C : Clear)
+			{
+				const double MinDist = Rules.CorridorClearance + R.Radius;
+				if (FVector2D::DistSquared(Pos, FMath::ClosestPointOnSegment2D(Pos, C.Key, C.Value)) < MinDist * MinDist) { bBlocked = true; break; }
+			}
+			for (int32 k = 0; k < Out.Num() && !bBlocked; ++k)
+			{
+				const double MinDist = R.Radius + Rules.Rules[Out[k].Rule].Radius;
+				bBlocked = FVector2D::DistSquared(Pos, Out[k].Position) < MinDist * MinDist;
+			}
+			if (bBlocked) continue;
+
+			FDungeonProp& Prop = Out.AddDefaulted_GetRef();
+			Prop.Position = Pos;
+			Prop.Yaw      = R.bSnapYawTo90 ? 90.f * Rng.RandHelper(4) : Rng.FRandRange(0.f, 360.f);
+			Prop.Scale    = Rng.FRandRange(R.ScaleRange.X, R.ScaleRange.Y);
+			Prop.Floor    = Room.Floor;
+			Prop.Rule     = RuleIndex;
+			break;
+		}
+	}
+}
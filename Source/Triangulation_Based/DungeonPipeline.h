@@ -0,0 +1,202 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DungeonTypes.h"
+#include "DungeonLayout.h"
+#include "DungeonGeometryKernel.h"
+
+// Copie des paramètres de ADungeonGenerator utilisés par la génération (aucun UObject : utilisable hors game thread)
+struct FDungeonGenParams
+{
+	int32     RoomsNbr = 32;
+	FVector2D RoomSizeMin = FVector2D(250, 250);
+	FVector2D RoomSizeMax = FVector2D(950, 950);
+	float     SpawnRadius = 1600.f;
+	EDungeonPlacementMode PlacementMode = EDungeonPlacementMode::UniformDisk;
+	int32     PoissonCandidates = 30;
+	int32     FloorCount = 1;      // > 1 : salles réparties sur plusieurs étages, graphe et relaxation en 3D
+	float     FloorHeight = 800.f;
+
+	int32 MaxRelaxIterations = 80;
+	float NudgeClamp = 100.f;
+	float ContactPadding = 2.f;
+
+	bool  bEnableCulling = true;
+	float CullPenetrationThreshold = 60.f;
+	int32 MaxCulls = 2;
+
+	int32 MainCount = 7;
+	float MinMainGap = 120.f;
+
+	// > 1 : génération hiérarchique. Les salles sont réparties en ClusterCount groupes générés en parallèle,
+	// puis les groupes sont écartés les uns des autres et reliés par un MST de second niveau.
+	int32 ClusterCount = 0;
+
+	bool  bBuildCorridors = true;
+	bool  bKeepOnlyMainAndPath = true;
+	float CorridorKeepDistance = 150.f;
+	bool  bCorridorFollowMSTExact = false;
+
+	// Mode compact (budget mémoire) : le layout ne garde pas les triangles/tétraèdres de Delaunay
+	// et les tableaux sont ajustés à leur taille. Ne change ni les salles ni le MST : hors du hash.
+	bool  bCompactLayout = false;
+
+	// Intérieur des salles (vide si aucun UDungeonPropSet)
+	FDungeonPropRules Props;
+
+	uint32 GetHash() const;
+};
+
+struct FDungeonStageMemory
+{
+	SIZE_T CurrentBytes = 0; // données de travail vivantes en fin d'étape
+	SIZE_T PeakBytes = 0;    // maximum observé pendant l'étape
+};
+
+struct FDungeonGenStats
+{
+	double PlaceMs = 0.0;
+	double RelaxMs = 0.0;
+	double CullMs = 0.0;
+	double MainRoomsMs = 0.0;
+	double GraphMs = 0.0;
+	double CorridorsMs = 0.0;
+	double PropsMs = 0.0;
+	double TotalMs = 0.0;
+	int32  RelaxIterations = 0;
+	int32  Culled = 0;
+	int32  Clusters = 0;      // génération hiérarchique : nombre de groupes (0 = à plat)
+	double ClusterMs = 0.0;   // groupes générés en parallèle puis écartés, temps mur
+
+	// Mémoire des conteneurs du pipeline, par étape (salles de travail, layout, graphe, couloirs)
+	FDungeonStageMemory PlaceMem, RelaxMem, CullMem, MainRoomsMem, GraphMem, CorridorsMem, PropsMem;
+	SIZE_T PeakBytes = 0;
+	SIZE_T SpawnBytes = 0; // acteurs/instances des salles, renseigné par ADungeonGenerator
+
+	// Assets du donjon (classe de salle, meshes, matériaux) chargés en parallèle du pipeline, renseigné par ADungeonGenerator
+	int32  Assets = 0;
+	double AssetLoadMs = 0.0; // requête -> dernier asset chargé
+	double AssetWaitMs = 0.0; // construction différée en attendant les assets
+	bool   bCompact = false;
+
+	void SampleMemory(FDungeonStageMemory& Stage, SIZE_T Bytes);
+	FString ToString() const;
+	FString MemoryToString() const;
+};
+
+enum class EDungeonCorridorStyle : uint8
+{
+	LShape,   // deux branches axées (ligne droite si les centres sont alignés)
+	Straight  // suit exactement l'arête du MST (bCorridorFollowMSTExact)
+};
+
+// Segments de couloir rangés par case d'une grille uniforme (boîte englobante), comme les cellules de
+// FDungeonPortalGraph : une salle ne regarde que les segments des cases qu'elle couvre. Lecture thread-safe.
+struct TRIANGULATION_BASED_API FDungeonSegmentGrid
+{
+	static constexpr double CellSize = 2000.0;
+
+	void Build(const TArray<FCorridorSeg>& Segments);
+	void Add(int32 Segment, const FCorridorSeg& S); // segments dégénérés ignorés (emplacements libérés)
+	void Remove(int32 Segment, const FCorridorSeg& S);
+	void Reset() { Cells.Reset(); }
+	// Segments dont la case touche [Min, Max], sans doublon, par indice croissant
+	void Query(const FVector2D& Min, const FVector2D& Max, TArray<int32, TInlineAllocator<16>>& Out) const;
+
+private:
+	static FIntPoint CellOf(const FVector2D& P);
+	TMap<FIntPoint, TArray<int32>> Cells;
+};
+
+// Pipeline de génération sur données pures : aucun acteur, thread-safe, déterministe pour une seed donnée
+struct TRIANGULATION_BASED_API FDungeonPipeline
+{
+	struct FRoomRef
+	{
+		FVector2D Center = FVector2D::ZeroVector;
+		FVector2D Half   = FVector2D::ZeroVector;
+		int32 Floor = 0;
+		int32 Cluster = 0; // groupe de la génération hiérarchique
+		bool bIsMain = false;
+		float Area() const { return 4.f * Half.X * Half.Y; }
+		float ClampedArea() const { return FMath::Max(1.f, 2.f * Half.X) * FMath::Max(1.f, 2.f * Half.Y); }
+	};
+
+	static void Generate(const FDungeonGenParams& P, int32 Seed, FDungeonLayout& Out, FDungeonGenStats* Stats = nullptr);
+
+	// Sélection des main rooms, graphe, couloirs et tri final à partir de salles déjà relaxées
+	// (en mode compact, Refs est vidé dès que les salles sont copiées dans le layout)
+	static void Finish(const FDungeonGenParams& P, TArray<FRoomRef>& Refs, FDungeonLayout& Out, FDungeonGenStats* Stats = nullptr);
+
+	// Étapes de Generate, lançables séparément (UDungeonSchedulerSubsystem) : salles placées et relaxées,
+	// puis main rooms + graphe + couloirs, puis props. Finish = FinishGraph + FinishProps.
+	static void PlaceAndRelax(const FDungeonGenParams& P, int32 Seed, TArray<FRoomRef>& Refs, FDungeonGenStats& Stats);
+	static void FinishGraph(const FDungeonGenParams& P, TArray<FRoomRef>& Refs, FDungeonLayout& Out, FDungeonGenStats* Stats = nullptr);
+	static void FinishProps(const FDungeonGenParams& P, FDungeonLayout& Out, FDungeonGenStats* Stats = nullptr);
+
+	// Generate quand ClusterCount > 1 : un PlaceAndRelax + main rooms + MST par groupe (ParallelFor), groupes
+	// écartés comme des disques, puis MST entre groupes sur les main rooms de frontière. Relaxation et culling,
+	// quadratiques, travaillent sur RoomsNbr / ClusterCount salles ; le MST global est une approximation
+	// (arêtes entre groupes voisins seulement).
+	static void GenerateHierarchical(const FDungeonGenParams& P, int32 Seed, FDungeonLayout& Out, FDungeonGenStats& Stats);
+
+	// Pic mémoire attendu du pipeline pour NumRooms salles (borne haute, avant toute génération)
+	static SIZE_T EstimatePeakBytes(const FDungeonGenParams& P, int32 NumRooms);
+
+	// ================= Génération des rooms =================
+	static FVector2D RandomPointInDisk(float Radius, FRandomStream& Rng);
+	static void PlaceRooms(const FDungeonGenParams& P, FRandomStream& Rng, TArray<FRoomRef>& Out);
+	static void PlaceRoomsPoisson(const FDungeonGenParams& P, FRandomStream& Rng, TArray<FRoomRef>& Out);
+
+	// ================= Relaxation Rooms =================
+	static bool Overlap(const FRoomRef& A, const FRoomRef& B, float Padding);
+	static FVector2D MTV(const FRoomRef& A, const FRoomRef& B);
+	static int32 RelaxOnce(const FDungeonGenParams& P, TArray<FRoomRef>& Refs);
+	static int32 RelaxOnceFloors(const FDungeonGenParams& P, TArray<FRoomRef>& Refs);
+
+	// ================= Culling =================
+	static int32 CullResidualOverlaps(const FDungeonGenParams& P, TArray<FRoomRef>& Refs);
+
+	// ================= Main Rooms =================
+	static bool TooCloseAABB(const FRoomRef& A, const FRoomRef& B, float ExtraGap);
+	static void SelectMainRooms(const FDungeonGenParams& P, TArray<FRoomRef>& Refs);
+	static void RelaxMainRoomsPositions(const FDungeonGenParams& P, TArray<FRoomRef>& Refs, const TArray<int32>& Mains);
+	static void SnapToLayoutGrid(TArray<FRoomRef>& Refs);
+	static void CopyRoomsToLayout(const TArray<FRoomRef>& Refs, FDungeonLayout& Out);
+
+	// ================= Génération hiérarchique =================
+	// Écarte des disques (centres Offsets, rayons Radii) jusqu'à ce qu'ils ne se chevauchent plus
+	static void SeparateClusterDisks(TArray<FVector2D>& Offsets, const TArray<double>& Radii);
+
+	// ================= Delaunay & Prim =================
+	static void BuildDelaunay(const TArray<FVector2D>& Points, TArray<FDGTriangle>& Out);
+	template<typename Kernel> // instancié pour les quatre noyaux 2D (float/double, rapide/exact)
+	static void BuildDelaunay(const TArray<typename Kernel::FVec>& Points, TArray<FDGTriangle>& Out);
+	static void EdgesFromTriangles(const TArray<FDGTriangle>& Tris, TSet<FDGEdge>& Out);
+	static void BuildMST_Prim(const TArray<FVector2D>& Points, const TSet<FDGEdge>& Edges, TArray<FDGEdge>& Out);
+	static void BuildMST_Kruskal(const TArray<FVector>& Points, const TSet<FDGEdge>& Edges, TArray<FDGEdge>& Out);
+
+	// ================= Corridors =================
+	static void MainRoomCenters(const FDungeonLayout& Layout, TArray<FVector2D>& OutPoints, TArray<int32>* OutRoomIndices = nullptr);
+	static void MainRoomCenters3D(const FDungeonLayout& Layout, float FloorHeight, TArray<FVector>& OutPoints, TArray<int32>* OutRoomIndices = nullptr);
+	static void BuildCorridors(const FDungeonGenParams& P, FDungeonLayout& Layout);
+	template<EDungeonCorridorStyle Style>
+	static void BuildCorridors(const FDungeonGenParams& P, FDungeonLayout& Layout);
+	// Couloir d'une seule arête du MST, de A vers B, ajouté à Out (mises à jour incrémentales)
+	static void BuildCorridor(const FDungeonGenParams& P, const FDungeonRoomDesc& A, const FDungeonRoomDesc& B, TArray<FCorridorSeg>& Out);
+	template<EDungeonCorridorStyle Style>
+	static void BuildCorridor(const FDungeonGenParams& P, const FDungeonRoomDesc& A, const FDungeonRoomDesc& B, TArray<FCorridorSeg>& Out);
+	static void KeepMainAndCorridorRooms(const FDungeonGenParams& P, FDungeonLayout& Layout);
+	// Couloirs du MST puis tri des salles ; WorkBytes : données de travail encore vivantes chez l'appelant
+	static void FinishCorridors(const FDungeonGenParams& P, FDungeonLayout& Out, FDungeonGenStats* Stats, SIZE_T WorkBytes = 0);
+
+	// ================= Props =================
+	// Une tâche par salle, flux aléatoire propre à la salle : même résultat quel que soit l'ordonnancement
+	static void PopulateRooms(const FDungeonGenParams& P, FDungeonLayout& Layout);
+	// Une salle seule (Out est remplacé), même tirage que PopulateRooms : sert aux salles ajoutées en cours de partie.
+	// Grid indexe Corridors ; seuls les segments des cases couvertes par la salle sont découpés.
+	static void PopulateRoom(const FDungeonGenParams& P, int32 Seed, const FDungeonRoomDesc& Room, const TArray<FCorridorSeg>& Corridors,
+		const FDungeonSegmentGrid& Grid, TArray<FDungeonProp>& Out);
+	// Partie du segment qui passe à moins de CorridorClearance de la salle, sur son étage : ce que PopulateRoom garde dégagé
+	static bool ClipCorridorToRoom(const FDungeonGenParams& P, const FDungeonRoomDesc& Room, const FCorridorSeg& S, FVector2D& OutA, FVector2D& OutB);
+};
@@ -0,0 +1,167 @@
+#include "DungeonPoolSubsystem.h"
+#include "DungeonGenerator.h"
+#include "Triangulation_Based.h"
+#include "Async/Async.h"
+#include "Tasks/Task.h"
+
+void UDungeonPoolSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+	SeedStream.Initialize(static_cast<int32>(FPlatformTime::Cycles()));
+
+	// La GameInstance ne sait pas encore si elle sera serveur ou client : on attend son premier monde
+	WorldInitHandle = FWorldDelegates::OnPostWorldInitialization.AddUObject(this, &UDungeonPoolSubsystem::OnWorldInitialized);
+}
+
+void UDungeonPoolSubsystem::OnWorldInitialized(UWorld* World, const UWorld::InitializationValues IVS)
+{
+	if (bPrimed || !World || !World->IsGameWorld() || World->GetGameInstance() != GetGameInstance()) return;
+	if (World->GetNetMode() == NM_Client) return; // Claim n'est jamais appelé sur un client
+
+	// Premier lot lancé avant le BeginPlay des acteurs, pas au premier Claim : sinon le premier donjon n'est jamais un hit
+	bPrimed = true;
+	FWorldDelegates::OnPostWorldInitialization.Remove(WorldInitHandle);
+	for (const TSubclassOf<ADungeonGenerator>& Class : PrimeGeneratorClasses)
+		if (Class) PrimeFromGenerator(Class.GetDefaultObject());
+	if (PrimeGeneratorClasses.Num() == 0 && GetDefault<ADungeonGenerator>()->bUsePregeneratedPool)
+		PrimeFromGenerator(GetDefault<ADungeonGenerator>());
+}
+
+void UDungeonPoolSubsystem::Deinitialize()
+{
+	// Les tâches en cours finissent sur des copies ; leur résultat est ignoré
+	bShuttingDown = true;
+	FWorldDelegates::OnPostWorldInitialization.Remove(WorldInitHandle);
+	Buckets.Reset();
+
+	UE_LOG(LogDungeon, Log, TEXT("Dungeon pool: %d claims, %d hits, %d refills (avg %.2f ms)"),
+		Claims, Hits, Refills, Refills > 0 ? TotalRefillMs / Refills : 0.0);
+
+	Super::Deinitialize();
+}
+
+bool UDungeonPoolSubsystem::Claim(const FDungeonGenParams& Params, FDungeonLayout& Out)
+{
+	const uint32 Key = KeyOf(Params);
+	FBucket& B = Buckets.FindOrAdd(Key);
+	B.Params = Params;
+
+	++Claims;
+	const bool bHit = B.Ready.Num() > 0;
+	if (bHit)
+	{
+		Out = B.Ready.Pop();
+		++Hits;
+	}
+
+	Refill();
+	return bHit;
+}
+
+void UDungeonPoolSubsystem::Prime(const FDungeonGenParams& Params)
+{
+	FBucket& B = Buckets.FindOrAdd(KeyOf(Params));
+	B.Params = Params;
+	Refill();
+}
+
+void UDungeonPoolSubsystem::PrimeFromGenerator(const ADungeonGenerator* Generator)
+{
+	if (IsValid(Generator)) Prime(Generator->MakeGenParams());
+}
+
+uint32 UDungeonPoolSubsystem::KeyOf(const FDungeonGenParams& Params)
+{
+	// Un générateur passé en mode compact par son budget ne doit pas recevoir un layout complet (triangles, tétraèdres)
+	return HashCombine(Params.GetHash(), GetTypeHash(Params.bCompactLayout));
+}
+
+FDungeonPoolStats UDungeonPoolSubsystem::GetStats() const
+{
+	FDungeonPoolStats S;
+	S.Claims       = Claims;
+	S.Hits         = Hits;
+	S.HitRate      = Claims > 0 ? static_cast<float>(Hits) / Claims : 0.f;
+	S.InFlightJobs = InFlightTotal;
+	S.PooledBytes  = static_cast<int32>(FMath::Min<SIZE_T>(PooledBytes(), MAX_int32));
+	S.Refills      = Refills;
+	S.AvgRefillMs  = Refills > 0 ? static_cast<float>(TotalRefillMs / Refills) : 0.f;
+	S.MaxRefillMs  = static_cast<float>(MaxRefillMs);
+	for (const auto& KV : Buckets) S.ReadyLayouts += KV.Value.Ready.Num();
+	return S;
+}
+
+SIZE_T UDungeonPoolSubsystem::PooledBytes() const
+{
+	SIZE_T Bytes = 0;
+	for (const auto& KV : Buckets)
+		for (const FDungeonLayout& L : KV.Value.Ready)
+			Bytes += sizeof(FDungeonLayout) + L.GetAllocatedSize();
+	return Bytes;
+}
+
+void UDungeonPoolSubsystem::Refill()
+{
+	if (bShuttingDown) return;
+
+	const SIZE_T Budget = static_cast<SIZE_T>(FMath::Max(0, MaxPoolMemoryKB)) * 1024;
+
+	for (auto& KV : Buckets)
+	{
+		FBucket& B = KV.Value;
+
+		// Estimation d'un layout à venir : la taille moyenne de ceux déjà prêts pour ces paramètres,
+		// ou le pic de génération tant qu'aucun n'est prêt (le premier lot respecte aussi le budget)
+		SIZE_T Estimate = 0;
+		for (const FDungeonLayout& L : B.Ready) Estimate += sizeof(FDungeonLayout) + L.GetAllocatedSize();
+		if (B.Ready.Num() > 0) Estimate /= B.Ready.Num();
+		else Estimate = sizeof(FDungeonLayout) + FDungeonPipeline::EstimatePeakBytes(B.Params, B.Params.RoomsNbr);
+
+		while (InFlightTotal < MaxConcurrentJobs && B.Ready.Num() + B.InFlight < LayoutsPerParamSet)
+		{
+			if (PooledBytes() + Estimate * (InFlightTotal + 1) > Budget) return;
+			LaunchJob(KV.Key, B);
+		}
+	}
+}
+
+void UDungeonPoolSubsystem::LaunchJob(uint32 Key, FBucket& Bucket)
+{
+	++Bucket.InFlight;
+	++InFlightTotal;
+
+	const FDungeonGenParams Params = Bucket.Params;
+	const int32 Seed = 1 + SeedStream.RandHelper(MAX_int32 - 1);
+	const double LaunchTime = FPlatformTime::Seconds();
+	TWeakObjectPtr<UDungeonPoolSubsystem> WeakThis(this);
+
+	UE::Tasks::Launch(UE_SOURCE_LOCATION, [WeakThis, Key, Params, Seed, LaunchTime]()
+	{
+		FDungeonLayout Layout;
+		FDungeonPipeline::Generate(Params, Seed, Layout);
+
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, Key, Layout = MoveTemp(Layout), LaunchTime]() mutable
+		{
+			if (UDungeonPoolSubsystem* This = WeakThis.Get())
+				This->OnJobDone(Key, MoveTemp(Layout), LaunchTime);
+		});
+	}, UE::Tasks::ETaskPriority::BackgroundNormal);
+}
+
+void UDungeonPoolSubsystem::OnJobDone(uint32 Key, FDungeonLayout&& Layout, double LaunchTime)
+{
+	InFlightTotal = FMath::Max(0, InFlightTotal - 1);
+	if (bShuttingDown) return;
+
+	FBucket* B = Buckets.Find(Key);
+	if (!B) return;
+	B->InFlight = FMath::Max(0, B->InFlight - 1);
+
+	const double Ms = (FPlatformTime::Seconds() - LaunchTime) * 1000.0;
+	++Refills;
+	TotalRefillMs += Ms;
+	MaxRefillMs = FMath::Max(MaxRefillMs, Ms);
+
+	B->Ready.Add(MoveTemp(Layout));
+	Refill();
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Engine/World.h"
+#include "DungeonPipeline.h"
+#include "DungeonPoolSubsystem.generated.h"
+
+USTRUCT(BlueprintType)
+struct FDungeonPoolStats
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category="DungeonPool") int32 Claims = 0;
+	UPROPERTY(BlueprintReadOnly, Category="DungeonPool") int32 Hits = 0;
+	UPROPERTY(BlueprintReadOnly, Category="DungeonPool") float HitRate = 0.f;
+	UPROPERTY(BlueprintReadOnly, Category="DungeonPool") int32 ReadyLayouts = 0;
+	UPROPERTY(BlueprintReadOnly, Category="DungeonPool") int32 InFlightJobs = 0;
+	UPROPERTY(BlueprintReadOnly, Category="DungeonPool") int32 PooledBytes = 0;
+	UPROPERTY(BlueprintReadOnly, Category="DungeonPool") int32 Refills = 0;
+	UPROPERTY(BlueprintReadOnly, Category="DungeonPool") float AvgRefillMs = 0.f;
+	UPROPERTY(BlueprintReadOnly, Category="DungeonPool") float MaxRefillMs = 0.f;
+};
+
+// Garde K layouts prêts par jeu de paramètres, générés en tâche de fond.
+// ADungeonGenerator en réclame un au BeginPlay et le pool se remplit derrière.
+// Côté serveur seulement : un client ne génère rien, il reconstruit le layout répliqué.
+UCLASS(Config=Game)
+class TRIANGULATION_BASED_API UDungeonPoolSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	// Prend un layout prêt s'il y en a un ; relance le remplissage dans tous les cas
+	bool Claim(const FDungeonGenParams& Params, FDungeonLayout& Out);
+	void Prime(const FDungeonGenParams& Params);
+
+	UFUNCTION(BlueprintCallable, Category="DungeonPool")
+	void PrimeFromGenerator(const class ADungeonGenerator* Generator);
+	UFUNCTION(BlueprintPure, Category="DungeonPool")
+	FDungeonPoolStats GetStats() const;
+
+	UPROPERTY(Config, EditAnywhere, Category="DungeonPool") int32 LayoutsPerParamSet = 4;
+	UPROPERTY(Config, EditAnywhere, Category="DungeonPool") int32 MaxPoolMemoryKB = 16384;
+	UPROPERTY(Config, EditAnywhere, Category="DungeonPool") int32 MaxConcurrentJobs = 2;
+	// Générateurs dont les paramètres par défaut sont pré-remplis au premier monde serveur ; vide : ADungeonGenerator s'il utilise le pool
+	UPROPERTY(Config, EditAnywhere, Category="DungeonPool") TArray<TSubclassOf<class ADungeonGenerator>> PrimeGeneratorClasses;
+
+private:
+	struct FBucket
+	{
+		FDungeonGenParams Params;
+		TArray<FDungeonLayout> Ready;
+		int32 InFlight = 0;
+	};
+
+	// Clé d'un seau : le mode compact ne change pas le layout mais ce qu'il garde en mémoire (GetHash l'ignore)
+	static uint32 KeyOf(const FDungeonGenParams& Params);
+	void OnWorldInitialized(UWorld* World, const UWorld::InitializationValues IVS);
+	void Refill();
+	void LaunchJob(uint32 Key, FBucket& Bucket);
+	void OnJobDone(uint32 Key, FDungeonLayout&& Layout, double LaunchTime);
+	SIZE_T PooledBytes() const;
+
+	TMap<uint32, FBucket> Buckets;
+	FRandomStream SeedStream;
+	int32 InFlightTotal = 0;
+	bool bShuttingDown = false;
+	bool bPrimed = false;
+	FDelegateHandle WorldInitHandle;
+
+	int32  Claims = 0;
+	int32  Hits = 0;
+	int32  Refills = 0;
+	double TotalRefillMs = 0.0;
+	double MaxRefillMs = 0.0;
+};
@@ -0,0 +1,268 @@
+#include "DungeonPortalGraph.h"
+#include "DungeonLayout.h"
+#include "DungeonGeometryKernel.h"
+
+namespace
+{
+	// Champ de vision horizontal : arc de Right à Left (sens trigonométrique), toujours < 180°
+	struct FWedge
+	{
+		FVector2D Right = FVector2D::ZeroVector;
+		FVector2D Left  = FVector2D::ZeroVector;
+		bool bFull = false;
+	};
+
+	bool InArc(const FVector2D& V, const FVector2D& Right, const FVector2D& Left)
+	{
+		return FVector2D::CrossProduct(Right, V) >= 0.0 && FVector2D::CrossProduct(V, Left) >= 0.0;
+	}
+
+	bool Contains(const FWedge& Outer, const FWedge& Inner)
+	{
+		if (Outer.bFull) return true;
+		if (Inner.bFull) return false;
+		return InArc(Inner.Right, Outer.Right, Outer.Left) && InArc(Inner.Left, Outer.Right, Outer.Left);
+	}
+
+	double DistToSegment(const FVector2D& P, const FVector2D& A, const FVector2D& B)
+	{
+		const FVector2D AB = B - A;
+		const double Len2 = AB.SizeSquared();
+		const double t = Len2 > 0.0 ? FMath::Clamp(FVector2D::DotProduct(P - A, AB) / Len2, 0.0, 1.0) : 0.0;
+		return FVector2D::Distance(P, A + AB * t);
+	}
+
+	// Portail vu depuis l'oeil : le champ de vision se réduit à la partie qui passe par l'ouverture
+	bool Narrow(const FWedge& W, const FDungeonPortal& Portal, const FVector2D& Eye, FWedge& Out)
+	{
+		if (Portal.A == Portal.B || DistToSegment(Eye, Portal.A, Portal.B) < 1.0)
+		{
+			Out = W; // passage ouvert, ou oeil dans l'ouverture
+			return true;
+		}
+
+		const FVector2D a = Portal.A - Eye;
+		const FVector2D b = Portal.B - Eye;
+		const double c = FVector2D::CrossProduct(a, b);
+		if (FMath::Abs(c) <= 1e-6 * a.Size() * b.Size()) return false; // vu par la tranche
+
+		const FVector2D R2 = c > 0.0 ? a : b;
+		const FVector2D L2 = c > 0.0 ? b : a;
+		if (W.bFull)
+		{
+			Out.Right = R2; Out.Left = L2; Out.bFull = false;
+			return true;
+		}
+
+		// Intersection de deux arcs < 180° : un seul morceau, bornes prises dans l'un ou l'autre
+		Out.Right = InArc(R2, W.Right, W.Left) ? R2 : W.Right;
+		Out.Left  = InArc(L2, W.Right, W.Left) ? L2 : W.Left;
+		Out.bFull = false;
+		return InArc(Out.Right, R2, L2) && InArc(Out.Left, R2, L2) && FVector2D::CrossProduct(Out.Right, Out.Left) >= 0.0;
+	}
+
+	// Ouverture dans le mur traversé au point X : plus large que le couloir quand il arrive en biais
+	void WallOpening(const FVector2D& X, const FVector2D& Dir, const FDungeonPortalCell& Room, float HalfWidth, FVector2D& OutA, FVector2D& OutB)
+	{
+		const FVector2D Off = X - Room.Center;
+		const bool bWallAlongY = FMath::Abs(FMath::Abs(Off.X) - Room.Half.X) <= FMath::Abs(FMath::Abs(Off.Y) - Room.Half.Y);
+		const FVector2D Along = bWallAlongY ? FVector2D(0, 1) : FVector2D(1, 0);
+		const double Cos = FMath::Abs(bWallAlongY ? Dir.X : Dir.Y);
+		const double Half = HalfWidth / FMath::Max(Cos, 0.25);
+		OutA = X - Along * Half;
+		OutB = X + Along * Half;
+	}
+}
+
+void FDungeonPortalGraph::Reset()
+{
+	Cells.Reset();
+	Portals.Reset();
+	Grid.Reset();
+	NumRooms = 0;
+}
+
+void FDungeonPortalGraph::AddToGrid(int32 Cell)
+{
+	const FDungeonPortalCell& C = Cells[Cell];
+	const FIntPoint Lo(FMath::FloorToInt((C.Center.X - C.Half.X) / GridSize), FMath::FloorToInt((C.Center.Y - C.Half.Y) / GridSize));
+	const FIntPoint Hi(FMath::FloorToInt((C.Center.X + C.Half.X) / GridSize), FMath::FloorToInt((C.Center.Y + C.Half.Y) / GridSize));
+	for (int32 y = Lo.Y; y <= Hi.Y; ++y)
+		for (int32 x = Lo.X; x <= Hi.X; ++x)
+			Grid.FindOrAdd(FIntPoint(x, y)).Add(Cell);
+}
+
+void FDungeonPortalGraph::GatherCandidates(const FVector2D& Min, const FVector2D& Max, TArray<int32>& Out, TArray<int32>& Stamp, int32 Epoch) const
+{
+	Out.Reset();
+	const FIntPoint Lo(FMath::FloorToInt(Min.X / GridSize), FMath::FloorToInt(Min.Y / GridSize));
+	const FIntPoint Hi(FMath::FloorToInt(Max.X / GridSize), FMath::FloorToInt(Max.Y / GridSize));
+	for (int32 y = Lo.Y; y <= Hi.Y; ++y)
+		for (int32 x = Lo.X; x <= Hi.X; ++x)
+			if (const TArray<int32>* Bucket = Grid.Find(FIntPoint(x, y)))
+				for (int32 c : *Bucket)
+				{
+					if (Stamp[c] == Epoch) continue;
+					Stamp[c] = Epoch;
+					Out.Add(c);
+				}
+}
+
+int32 FDungeonPortalGraph::AddPortal(const FVector2D& A, const FVector2D& B, int32 CellA, int32 CellB)
+{
+	const int32 Idx = Portals.Add({ A, B, CellA, CellB });
+	Cells[CellA].Portals.Add(Idx);
+	Cells[CellB].Portals.Add(Idx);
+	return Idx;
+}
+
+void FDungeonPortalGraph::Build(const FDungeonLayout& Layout, float CorridorWidth, float FloorHeight)
+{
+	Reset();
+	HalfWidth = CorridorWidth * 0.5f;
+	NumRooms = Layout.Rooms.Num();
+	Cells.SetNum(NumRooms + Layout.Corridors.Num());
+
+	for (int32 r = 0; r < NumRooms; ++r)
+	{
+		const FDungeonRoomDesc& D = Layout.Rooms[r];
+		FDungeonPortalCell& C = Cells[r];
+		C.Center = D.Center;
+		C.Half = D.Size * 0.5;
+		C.FloorMin = C.FloorMax = D.Floor;
+		AddToGrid(r);
+	}
+
+	const float InvFloor = FloorHeight > 0.f ? 1.f / FloorHeight : 0.f;
+	for (int32 s = 0; s < Layout.Corridors.Num(); ++s)
+	{
+		const FCorridorSeg& S = Layout.Corridors[s];
+		if (S.A == S.B) continue; // segment dégénéré ou emplacement libre : cellule isolée
+		FDungeonPortalCell& C = Cells[NumRooms + s];
+		C.A = S.A;
+		C.B = S.B;
+		C.Center = (S.A + S.B) * 0.5;
+		C.Half = (S.B - S.A).GetAbs() * 0.5 + FVector2D(HalfWidth, HalfWidth);
+		C.FloorMin = FMath::RoundToInt(FMath::Min(S.ZA, S.ZB) * InvFloor);
+		C.FloorMax = FMath::RoundToInt(FMath::Max(S.ZA, S.ZB) * InvFloor);
+		AddToGrid(NumRooms + s);
+	}
+
+	TArray<int32> Stamp;
+	Stamp.Init(0, Cells.Num());
+	int32 Epoch = 0;
+	TArray<int32> Candidates;
+	for (int32 s = NumRooms; s < Cells.Num(); ++s)
+	{
+		if (Cells[s].A == Cells[s].B) continue;
+		const FVector2D SA = Cells[s].A, SB = Cells[s].B;
+		const FVector2D Dir = (SB - SA).GetSafeNormal();
+		GatherCandidates(Cells[s].Center - Cells[s].Half, Cells[s].Center + Cells[s].Half, Candidates, Stamp, ++Epoch);
+
+		for (int32 c : Candidates)
+		{
+			const FDungeonPortalCell& O = Cells[c];
+			if (O.FloorMax < Cells[s].FloorMin || O.FloorMin > Cells[s].FloorMax) continue;
+
+			if (c < NumRooms)
+			{
+				// Entrées et sorties du couloir dans la salle
+				double u0, u1;
+				if (!FDungeonKernel2D::ClipSegment(SA, SB, O.Center, O.Half, u0, u1)) continue;
+				if (u0 <= 0.0 && u1 >= 1.0)
+				{
+					AddPortal(SA, SA, s, c);
+					continue;
+				}
+				FVector2D PA, PB;
+				if (u0 > 0.0) { WallOpening(SA + (SB - SA) * u0, Dir, O, HalfWidth, PA, PB); AddPortal(PA, PB, s, c); }
+				if (u1 < 1.0) { WallOpening(SA + (SB - SA) * u1, Dir, O, HalfWidth, PA, PB); AddPortal(PA, PB, s, c); }
+			}
+			else if (c > s)
+			{
+				// Coude ou croisement : les emprises des deux segments se touchent
+				FVector P0, P1;
+				FMath::SegmentDistToSegmentSafe(FVector(SA, 0.0), FVector(SB, 0.0), FVector(O.A, 0.0), FVector(O.B, 0.0), P0, P1);
+				if (FVector::DistSquared(P0, P1) > FMath::Square(CorridorWidth)) continue;
+				const FVector2D Mid((P0.X + P1.X) * 0.5, (P0.Y + P1.Y) * 0.5);
+				AddPortal(Mid, Mid, s, c);
+			}
+		}
+	}
+}
+
+bool FDungeonPortalGraph::InCell(int32 Cell, const FVector2D& P, int32 Floor) const
+{
+	const FDungeonPortalCell& C = Cells[Cell];
+	if (Floor < C.FloorMin || Floor > C.FloorMax) return false;
+	if (Cell < NumRooms) return FMath::Abs(P.X - C.Center.X) <= C.Half.X && FMath::Abs(P.Y - C.Center.Y) <= C.Half.Y;
+	return C.A != C.B && DistToSegment(P, C.A, C.B) <= HalfWidth;
+}
+
+int32 FDungeonPortalGraph::FindRoom(const FVector2D& P, int32 Floor) const
+{
+	const TArray<int32>* Bucket = Grid.Find(FIntPoint(FMath::FloorToInt(P.X / GridSize), FMath::FloorToInt(P.Y / GridSize)));
+	if (!Bucket) return INDEX_NONE;
+	for (int32 c : *Bucket)
+		if (c < NumRooms && InCell(c, P, Floor)) return c;
+	return INDEX_NONE;
+}
+
+int32 FDungeonPortalGraph::FindCell(const FVector2D& P, int32 Floor) const
+{
+	const int32 Room = FindRoom(P, Floor);
+	if (Room != INDEX_NONE) return Room;
+
+	const TArray<int32>* Bucket = Grid.Find(FIntPoint(FMath::FloorToInt(P.X / GridSize), FMath::FloorToInt(P.Y / GridSize)));
+	if (!Bucket) return INDEX_NONE;
+	for (int32 c : *Bucket)
+		if (c >= NumRooms && InCell(c, P, Floor)) return c;
+	return INDEX_NONE;
+}
+
+bool FDungeonPortalGraph::ComputeVisible(const FVector2D& Eye, int32 Floor, const FVector2D& Forward, float HalfFov, bool bFullTurn,
+	int32 MaxVisits, TBitArray<>& OutVisible) const
+{
+	OutVisible.Init(false, Cells.Num());
+	const int32 Start = FindCell(Eye, Floor);
+	if (Start == INDEX_NONE) return false;
+
+	FWedge View;
+	View.bFull = bFullTurn;
+	if (!bFullTurn)
+	{
+		const float Half = FMath::Min(HalfFov, 89.f);
+		View.Right = Forward.GetRotated(-Half);
+		View.Left  = Forward.GetRotated(Half);
+	}
+
+	struct FVisit
+	{
+		int32 Cell;
+		int32 From; // portail d'arrivée, pas de demi-tour
+		FWedge View;
+	};
+	TArray<FVisit, TInlineAllocator<64>> Stack;
+	Stack.Add({ Start, INDEX_NONE, View });
+
+	// Une cellule déjà atteinte avec un champ plus large n'apporte rien de nouveau : coupe aussi les cycles
+	TMap<int32, TArray<FWedge, TInlineAllocator<2>>> Seen;
+	for (int32 Visits = 0; Stack.Num() > 0 && Visits < MaxVisits; ++Visits)
+	{
+		const FVisit V = Stack.Pop(EAllowShrinking::No);
+		TArray<FWedge, TInlineAllocator<2>>& CellSeen = Seen.FindOrAdd(V.Cell);
+		if (CellSeen.ContainsByPredicate([&V](const FWedge& W) { return Contains(W, V.View); })) continue;
+		CellSeen.Add(V.View);
+		OutVisible[V.Cell] = true;
+
+		for (int32 p : Cells[V.Cell].Portals)
+		{
+			if (p == V.From) continue;
+			const FDungeonPortal& Portal = Portals[p];
+			FWedge Next;
+			if (!Narrow(V.View, Portal, Eye, Next)) continue;
+			Stack.Add({ Portal.CellA == V.Cell ? Portal.CellB : Portal.CellA, p, Next });
+		}
+	}
+	return Stack.Num() == 0; // budget épuisé : visibilité incomplète, rien ne doit être masqué
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DungeonTypes.h"
+
+struct FDungeonLayout;
+
+// Ouverture entre deux cellules, vue de dessus. A == B : passage sans bord (coude d'un couloir,
+// croisement), qui ne rétrécit pas le champ de vision.
+struct FDungeonPortal
+{
+	FVector2D A = FVector2D::ZeroVector;
+	FVector2D B = FVector2D::ZeroVector;
+	int32 CellA = INDEX_NONE;
+	int32 CellB = INDEX_NONE;
+};
+
+// Cellule : une salle (indices [0, NumRooms)) ou un segment de couloir (NumRooms + index du segment)
+struct FDungeonPortalCell
+{
+	FVector2D Center = FVector2D::ZeroVector;
+	FVector2D Half   = FVector2D::ZeroVector; // boîte englobante
+	FVector2D A = FVector2D::ZeroVector, B = FVector2D::ZeroVector; // axe d'un couloir
+	int32 FloorMin = 0, FloorMax = 0;         // une rampe couvre deux étages
+	TArray<int32, TInlineAllocator<4>> Portals;
+};
+
+// Graphe de portails du donjon, en coordonnées du layout (relatives au centre du donjon).
+// Les portails sont les points où les couloirs entrent dans les salles : la visibilité depuis la caméra
+// se propage de cellule en cellule à travers eux, le champ de vision se rétrécissant à chaque ouverture.
+// Aucun UObject.
+struct TRIANGULATION_BASED_API FDungeonPortalGraph
+{
+	TArray<FDungeonPortalCell> Cells;
+	TArray<FDungeonPortal> Portals;
+	int32 NumRooms = 0;
+
+	void Reset();
+	void Build(const FDungeonLayout& Layout, float CorridorWidth, float FloorHeight);
+	bool IsEmpty() const { return Cells.Num() == 0; }
+
+	int32 FindRoom(const FVector2D& P, int32 Floor) const;
+	int32 FindCell(const FVector2D& P, int32 Floor) const; // salle d'abord, sinon couloir ; INDEX_NONE hors du donjon
+
+	// Cellules visibles depuis Eye, regard Forward (2D normé), demi-angle HalfFov en degrés (< 90).
+	// bFullTurn : tout l'horizon (caméra très inclinée). Faux si l'oeil n'est dans aucune cellule ou si
+	// MaxVisits est atteint : l'appelant affiche alors tout.
+	bool ComputeVisible(const FVector2D& Eye, int32 Floor, const FVector2D& Forward, float HalfFov, bool bFullTurn,
+		int32 MaxVisits, TBitArray<>& OutVisible) const;
+
+private:
+	static constexpr double GridSize = 2000.0;
+
+	float HalfWidth = 0.f;
+	TMap<FIntPoint, TArray<int32>> Grid; // cellules par case de la grille, pour FindCell et la construction
+
+	void AddToGrid(int32 Cell);
+	void GatherCandidates(const FVector2D& Min, const FVector2D& Max, TArray<int32>& Out, TArray<int32>& Stamp, int32 Epoch) const;
+	int32 AddPortal(const FVector2D& A, const FVector2D& B, int32 CellA, int32 CellB);
+	bool InCell(int32 Cell, const FVector2D& P, int32 Floor) const;
+};
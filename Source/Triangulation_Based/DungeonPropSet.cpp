@@ -0,0 +1,25 @@
+#include "DungeonPropSet.h"
+
+void UDungeonPropSet::ToRules(FDungeonPropRules& Out) const
+{
+	Out = FDungeonPropRules();
+	Out.DensityPerSquareMeter = DensityPerSquareMeter;
+	Out.MaxPerRoom = MaxPerRoom;
+	Out.WallMargin = WallMargin;
+	Out.CorridorClearance = CorridorClearance;
+	Out.MaxAttemptsPerProp = FMath::Max(1, MaxAttemptsPerProp);
+
+	for (int32 i = 0; i < Props.Num(); ++i)
+	{
+		const FDungeonPropEntry& E = Props[i];
+		if (E.Mesh.IsNull() || E.Weight <= 0.f) continue;
+
+		FDungeonPropRule& R = Out.Rules.AddDefaulted_GetRef();
+		R.Entry = i;
+		R.Weight = E.Weight;
+		R.Radius = FMath::Max(0.f, E.Radius);
+		R.ScaleRange = FVector2D(FMath::Min(E.ScaleRange.X, E.ScaleRange.Y), FMath::Max(E.ScaleRange.X, E.ScaleRange.Y));
+		R.bSnapYawTo90 = E.bSnapYawTo90;
+		R.bMainRoomsOnly = E.bMainRoomsOnly;
+	}
+}
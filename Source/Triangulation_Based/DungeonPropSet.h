@@ -0,0 +1,37 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "DungeonTypes.h"
+#include "DungeonPropSet.generated.h"
+
+USTRUCT(BlueprintType)
+struct FDungeonPropEntry
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Prop") TSoftObjectPtr<class UStaticMesh> Mesh; // chargé par le générateur avant la construction
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Prop", meta=(ClampMin=0)) float Weight = 1.f;
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Prop", meta=(ClampMin=0)) float Radius = 50.f;
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Prop") FVector2D ScaleRange = FVector2D(1.f, 1.f);
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Prop") bool bSnapYawTo90 = false;
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Prop") bool bMainRoomsOnly = false;
+};
+
+// Jeu de props dont on remplit l'intérieur des salles : un HISM par mesh, aucun acteur
+UCLASS(BlueprintType)
+class TRIANGULATION_BASED_API UDungeonPropSet : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Props") TArray<FDungeonPropEntry> Props;
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Props", meta=(ClampMin=0)) float DensityPerSquareMeter = 0.05f;
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Props", meta=(ClampMin=0)) int32 MaxPerRoom = 24;
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Props", meta=(ClampMin=0)) float WallMargin = 40.f;
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Props", meta=(ClampMin=0)) float CorridorClearance = 200.f;
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Props", meta=(ClampMin=1)) int32 MaxAttemptsPerProp = 8;
+
+	// Copie en données pures pour le pipeline (entrées sans mesh ou de poids nul ignorées)
+	void ToRules(FDungeonPropRules& Out) const;
+};
@@ -0,0 +1,57 @@
+#include "DungeonProxyBuilder.h"
+
+namespace
+{
+	// Faces du cube [-50, 50]^3 : normale et quatre coins en sens horaire vu de l'extérieur (face avant dans Unreal)
+	struct FCubeFace
+	{
+		FVector Normal;
+		FVector Corners[4];
+	};
+
+	const FCubeFace CubeFaces[6] =
+	{
+		{ FVector( 1, 0, 0), { FVector( 50, -50, -50), FVector( 50,  50, -50), FVector( 50,  50,  50), FVector( 50, -50,  50) } },
+		{ FVector(-1, 0, 0), { FVector(-50,  50, -50), FVector(-50, -50, -50), FVector(-50, -50,  50), FVector(-50,  50,  50) } },
+		{ FVector( 0, 1, 0), { FVector( 50,  50, -50), FVector(-50,  50, -50), FVector(-50,  50,  50), FVector( 50,  50,  50) } },
+		{ FVector( 0,-1, 0), { FVector(-50, -50, -50), FVector( 50, -50, -50), FVector( 50, -50,  50), FVector(-50, -50,  50) } },
+		{ FVector( 0, 0, 1), { FVector(-50, -50,  50), FVector( 50, -50,  50), FVector( 50,  50,  50), FVector(-50,  50,  50) } },
+		{ FVector( 0, 0,-1), { FVector(-50,  50, -50), FVector( 50,  50, -50), FVector( 50, -50, -50), FVector(-50, -50, -50) } },
+	};
+}
+
+void FDungeonProxyBuilder::Build(const TArray<FTransform>& Boxes, float CellSize, TArray<FDungeonProxyCell>& OutCells)
+{
+	OutCells.Reset();
+	const double Cell = FMath::Max(1.0, static_cast<double>(CellSize));
+
+	TMap<FIntPoint, int32> CellIndex;
+	for (const FTransform& Box : Boxes)
+	{
+		const FVector C = Box.GetLocation();
+		const FIntPoint Key(FMath::FloorToInt32(C.X / Cell), FMath::FloorToInt32(C.Y / Cell));
+
+		int32& Index = CellIndex.FindOrAdd(Key, INDEX_NONE);
+		if (Index == INDEX_NONE)
+		{
+			Index = OutCells.AddDefaulted();
+			OutCells[Index].Key = Key;
+		}
+		FDungeonProxyCell& Out = OutCells[Index];
+
+		// 4 sommets par face pour garder des normales franches ; la face du dessous reste, une salle peut être vue d'en bas
+		for (const FCubeFace& F : CubeFaces)
+		{
+			const int32 Base = Out.Vertices.Num();
+			const FVector N = Box.TransformVectorNoScale(F.Normal);
+			for (const FVector& Corner : F.Corners)
+			{
+				const FVector V = Box.TransformPosition(Corner);
+				Out.Vertices.Add(V);
+				Out.Normals.Add(N);
+				Out.Bounds += V;
+			}
+			Out.Triangles.Append({ Base, Base + 1, Base + 2, Base, Base + 2, Base + 3 });
+		}
+	}
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Géométrie fusionnée d'une cellule : une section de mesh, un draw call
+struct FDungeonProxyCell
+{
+	FIntPoint Key = FIntPoint::ZeroValue;
+	FBox Bounds = FBox(ForceInit);
+	TArray<FVector> Vertices;
+	TArray<int32> Triangles;
+	TArray<FVector> Normals;
+};
+
+// Proxy basse résolution du donjon pour la vue lointaine : chaque boîte est un cube unitaire de 100 uu
+// (celui des salles et des couloirs) transformé, regroupé par cellule XY. Aucun UObject : exécutable en tâche de fond.
+struct TRIANGULATION_BASED_API FDungeonProxyBuilder
+{
+	static void Build(const TArray<FTransform>& Boxes, float CellSize, TArray<FDungeonProxyCell>& OutCells);
+};
@@ -0,0 +1,223 @@
+#include "DungeonSchedulerSubsystem.h"
+#include "DungeonGenerator.h"
+#include "Triangulation_Based.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "Algo/StableSort.h"
+
+bool UDungeonSchedulerSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UDungeonSchedulerSubsystem::Deinitialize()
+{
+	// Les tâches en vol finissent sur leur job partagé ; leur résultat est ignoré
+	for (const FJobRef& Job : InFlight) Job->bCancelled = true;
+	Cancelled += Pending.Num() + InFlight.Num() + Ready.Num();
+	Pending.Reset();
+	InFlight.Reset();
+	Ready.Reset();
+
+	UE_LOG(LogDungeon, Log, TEXT("Dungeon scheduler: %d submitted, %d committed, %d cancelled (avg queue %.2f ms, run %.2f ms)"),
+		Submitted, Committed, Cancelled, Launched > 0 ? TotalQueueMs / Launched : 0.0, Launched > 0 ? TotalRunMs / Launched : 0.0);
+
+	Super::Deinitialize();
+}
+
+TStatId UDungeonSchedulerSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UDungeonSchedulerSubsystem, STATGROUP_Tickables);
+}
+
+void UDungeonSchedulerSubsystem::Submit(ADungeonGenerator* Generator, const FDungeonGenParams& Params, int32 Seed)
+{
+	Cancel(Generator); // un seul job par générateur
+
+	FJobRef Job = MakeShared<FJob, ESPMode::ThreadSafe>();
+	Job->Generator = Generator;
+	Job->Params = Params;
+	Job->Seed = Seed;
+	Job->SubmitTime = FPlatformTime::Seconds();
+	Job->Stats.bCompact = Params.bCompactLayout;
+
+	if (Pending.Num() + InFlight.Num() + Ready.Num() == 0)
+	{
+		BatchStart = Job->SubmitTime;
+		BatchCommitted = Committed;
+	}
+	Pending.Add(Job);
+	++Submitted;
+}
+
+void UDungeonSchedulerSubsystem::Cancel(const ADungeonGenerator* Generator)
+{
+	auto Matches = [Generator](const FJobRef& Job) { return Job->Generator.Get() == Generator || !Job->Generator.IsValid(); };
+	for (const FJobRef& Job : InFlight)
+		if (Matches(Job)) Job->bCancelled = true;
+
+	Cancelled += Pending.RemoveAll(Matches) + InFlight.RemoveAll(Matches) + Ready.RemoveAll(Matches);
+}
+
+FDungeonSchedulerStats UDungeonSchedulerSubsystem::GetStats() const
+{
+	FDungeonSchedulerStats S;
+	S.Submitted     = Submitted;
+	S.Committed     = Committed;
+	S.Cancelled     = Cancelled;
+	S.Pending       = Pending.Num();
+	S.InFlight      = InFlight.Num();
+	S.WaitingCommit = Ready.Num();
+	S.AvgQueueMs    = Launched > 0 ? static_cast<float>(TotalQueueMs / Launched) : 0.f;
+	S.AvgRunMs      = Launched > 0 ? static_cast<float>(TotalRunMs / Launched) : 0.f;
+	S.MaxCommitMs   = static_cast<float>(MaxCommitMs);
+	return S;
+}
+
+void UDungeonSchedulerSubsystem::UpdateDistances(TArray<FJobRef>& Jobs) const
+{
+	// Distance au joueur le plus proche ; sans joueur (serveur dédié au démarrage), l'ordre de soumission
+	TArray<FVector, TInlineAllocator<4>> Viewers;
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* PC = It->Get();
+		if (PC && PC->PlayerCameraManager) Viewers.Add(PC->PlayerCameraManager->GetCameraLocation());
+		else if (PC && PC->GetPawn()) Viewers.Add(PC->GetPawn()->GetActorLocation());
+	}
+
+	for (const FJobRef& Job : Jobs)
+	{
+		const ADungeonGenerator* Generator = Job->Generator.Get();
+		Job->Distance = TNumericLimits<double>::Max();
+		if (!Generator) continue;
+		for (const FVector& V : Viewers)
+			Job->Distance = FMath::Min(Job->Distance, FVector::Dist(V, Generator->GetActorLocation()));
+	}
+	Algo::StableSortBy(Jobs, [](const FJobRef& Job) { return Job->Distance; });
+}
+
+void UDungeonSchedulerSubsystem::Launch(const FJobRef& Job, bool bUrgent)
+{
+	Job->LaunchTime = FPlatformTime::Seconds();
+	TotalQueueMs += (Job->LaunchTime - Job->SubmitTime) * 1000.0;
+	++Launched;
+
+	const UE::Tasks::ETaskPriority Priority = bUrgent ? UE::Tasks::ETaskPriority::Normal : UE::Tasks::ETaskPriority::BackgroundHigh;
+
+	// Génération hiérarchique : une seule tâche, ses groupes se répartissent déjà sur les workers (ParallelFor)
+	if (Job->Params.ClusterCount > 1)
+	{
+		Job->Done = UE::Tasks::Launch(UE_SOURCE_LOCATION, [Job]()
+		{
+			if (Job->bCancelled) return;
+			FDungeonPipeline::Generate(Job->Params, Job->Seed, Job->Layout, &Job->Stats);
+			Job->DoneTime = FPlatformTime::Seconds();
+			Job->Stats.TotalMs = (Job->DoneTime - Job->LaunchTime) * 1000.0;
+		}, Priority);
+		InFlight.Add(Job);
+		return;
+	}
+
+	// Trois étapes enchaînées par prérequis : entre deux étapes, les workers libres prennent celles des autres jobs
+	UE::Tasks::FTask Rooms = UE::Tasks::Launch(UE_SOURCE_LOCATION, [Job]()
+	{
+		if (Job->bCancelled) return;
+		FDungeonPipeline::PlaceAndRelax(Job->Params, Job->Seed, Job->Refs, Job->Stats);
+	}, Priority);
+
+	UE::Tasks::FTask Graph = UE::Tasks::Launch(UE_SOURCE_LOCATION, [Job]()
+	{
+		if (Job->bCancelled) return;
+		Job->Layout.Seed = Job->Seed;
+		FDungeonPipeline::FinishGraph(Job->Params, Job->Refs, Job->Layout, &Job->Stats);
+		Job->Refs.Empty();
+	}, UE::Tasks::Prerequisites(Rooms), Priority);
+
+	Job->Done = UE::Tasks::Launch(UE_SOURCE_LOCATION, [Job]()
+	{
+		if (Job->bCancelled) return;
+		FDungeonPipeline::FinishProps(Job->Params, Job->Layout, &Job->Stats);
+		Job->DoneTime = FPlatformTime::Seconds();
+		Job->Stats.TotalMs = (Job->DoneTime - Job->LaunchTime) * 1000.0;
+	}, UE::Tasks::Prerequisites(Graph), Priority);
+
+	InFlight.Add(Job);
+}
+
+void UDungeonSchedulerSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	// Jobs terminés : en attente de commit
+	for (int32 i = InFlight.Num() - 1; i >= 0; --i)
+	{
+		if (!InFlight[i]->Done.IsCompleted()) continue;
+		const FJobRef Job = InFlight[i];
+		InFlight.RemoveAtSwap(i, 1, EAllowShrinking::No);
+		TotalRunMs += (Job->DoneTime - Job->LaunchTime) * 1000.0;
+		Ready.Add(Job);
+	}
+
+	// Lancements : le plus proche d'un joueur d'abord, en tête des workers
+	if (Pending.Num() > 0)
+	{
+		const int32 Slots = (MaxConcurrentJobs > 0) ? MaxConcurrentJobs : FMath::Max(1, FTaskGraphInterface::Get().GetNumWorkerThreads());
+		UpdateDistances(Pending);
+		int32 Started = 0;
+		while (Pending.Num() > 0 && InFlight.Num() < Slots)
+		{
+			Launch(Pending[0], Started++ == 0);
+			Pending.RemoveAt(0, 1, EAllowShrinking::No);
+		}
+	}
+
+	// Commits sur le game thread : au plus MaxCommitsPerFrame, et pas au-delà du budget (le premier passe toujours).
+	// Un générateur dont les assets sont encore en chargement attend la frame suivante plutôt que de bloquer.
+	if (Ready.Num() > 0)
+	{
+		UpdateDistances(Ready);
+		const double FrameStart = FPlatformTime::Seconds();
+		int32 Commits = 0;
+		while (Ready.Num() > 0 && Commits < FMath::Max(1, MaxCommitsPerFrame))
+		{
+			if (Commits > 0 && (FPlatformTime::Seconds() - FrameStart) * 1000.0 >= CommitBudgetMs) break;
+			const int32 Index = Ready.IndexOfByPredicate([](const FJobRef& Job)
+			{
+				const ADungeonGenerator* Generator = Job->Generator.Get();
+				return !Generator || Generator->AreAssetsReady();
+			});
+			if (Index == INDEX_NONE) break;
+			const FJobRef Job = Ready[Index];
+			Ready.RemoveAt(Index, 1, EAllowShrinking::No);
+			Commit(*Job);
+			++Commits;
+		}
+
+		if (Pending.Num() + InFlight.Num() + Ready.Num() == 0)
+		{
+			UE_LOG(LogDungeon, Log, TEXT("Dungeon scheduler drained: %d dungeons in %.2f ms wall time"),
+				Committed - BatchCommitted, (FPlatformTime::Seconds() - BatchStart) * 1000.0);
+		}
+	}
+}
+
+void UDungeonSchedulerSubsystem::Commit(FJob& Job)
+{
+	ADungeonGenerator* Generator = Job.Generator.Get();
+	if (!Generator)
+	{
+		++Cancelled;
+		return;
+	}
+
+	const double Start = FPlatformTime::Seconds();
+	Generator->ApplyScheduledLayout(MoveTemp(Job.Layout), Job.Stats);
+	const double Ms = (FPlatformTime::Seconds() - Start) * 1000.0;
+	MaxCommitMs = FMath::Max(MaxCommitMs, Ms);
+	++Committed;
+
+	UE_LOG(LogDungeon, Verbose, TEXT("Scheduled dungeon %s committed (seed %d): queue %.2f ms, run %.2f ms, commit %.2f ms"),
+		*Generator->GetName(), Job.Seed, (Job.LaunchTime - Job.SubmitTime) * 1000.0, (Job.DoneTime - Job.LaunchTime) * 1000.0, Ms);
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tasks/Task.h"
+#include "DungeonPipeline.h"
+#include "DungeonSchedulerSubsystem.generated.h"
+
+USTRUCT(BlueprintType)
+struct FDungeonSchedulerStats
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category="DungeonScheduler") int32 Submitted = 0;
+	UPROPERTY(BlueprintReadOnly, Category="DungeonScheduler") int32 Committed = 0;
+	UPROPERTY(BlueprintReadOnly, Category="DungeonScheduler") int32 Cancelled = 0;
+	UPROPERTY(BlueprintReadOnly, Category="DungeonScheduler") int32 Pending = 0;
+	UPROPERTY(BlueprintReadOnly, Category="DungeonScheduler") int32 InFlight = 0;
+	UPROPERTY(BlueprintReadOnly, Category="DungeonScheduler") int32 WaitingCommit = 0;
+	UPROPERTY(BlueprintReadOnly, Category="DungeonScheduler") float AvgQueueMs = 0.f;  // soumission -> lancement
+	UPROPERTY(BlueprintReadOnly, Category="DungeonScheduler") float AvgRunMs = 0.f;    // lancement -> layout prêt
+	UPROPERTY(BlueprintReadOnly, Category="DungeonScheduler") float MaxCommitMs = 0.f; // BuildFromLayout sur le game thread
+};
+
+// Ordonnanceur partagé par tous les ADungeonGenerator d'un monde. Chaque génération est découpée en étapes
+// (salles, graphe + couloirs, props) enchaînées sur UE::Tasks, dont le pool de workers vole le travail :
+// le temps total suit le nombre de coeurs, pas le nombre de générateurs. Les jobs les plus proches d'un
+// joueur partent en premier, et les layouts prêts sont appliqués sur le game thread avec une limite par frame.
+UCLASS(Config=Game)
+class TRIANGULATION_BASED_API UDungeonSchedulerSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	void Submit(class ADungeonGenerator* Generator, const FDungeonGenParams& Params, int32 Seed);
+	void Cancel(const class ADungeonGenerator* Generator);
+
+	UFUNCTION(BlueprintPure, Category="DungeonScheduler")
+	FDungeonSchedulerStats GetStats() const;
+
+	UPROPERTY(Config, EditAnywhere, Category="DungeonScheduler") int32 MaxConcurrentJobs = 0; // 0 = un par worker
+	UPROPERTY(Config, EditAnywhere, Category="DungeonScheduler") int32 MaxCommitsPerFrame = 1;
+	UPROPERTY(Config, EditAnywhere, Category="DungeonScheduler") float CommitBudgetMs = 4.f;   // au-delà, les commits suivants attendent la frame d'après
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	// Partagé avec les tâches : le subsystem peut disparaître avant elles
+	struct FJob
+	{
+		TWeakObjectPtr<class ADungeonGenerator> Generator;
+		FDungeonGenParams Params;
+		int32 Seed = 0;
+		TArray<FDungeonPipeline::FRoomRef> Refs;
+		FDungeonLayout Layout;
+		FDungeonGenStats Stats;
+		std::atomic<bool> bCancelled = false;
+		double SubmitTime = 0.0;
+		double LaunchTime = 0.0;
+		double DoneTime = 0.0;
+		double Distance = 0.0;
+		UE::Tasks::FTask Done;
+	};
+	using FJobRef = TSharedRef<FJob, ESPMode::ThreadSafe>;
+
+	void UpdateDistances(TArray<FJobRef>& Jobs) const;
+	void Launch(const FJobRef& Job, bool bUrgent);
+	void Commit(FJob& Job);
+
+	TArray<FJobRef> Pending;
+	TArray<FJobRef> InFlight;
+	TArray<FJobRef> Ready;
+
+	int32  Submitted = 0;
+	int32  Committed = 0;
+	int32  Cancelled = 0;
+	int32  Launched = 0;
+	double TotalQueueMs = 0.0;
+	double TotalRunMs = 0.0;
+	double MaxCommitMs = 0.0;
+	double BatchStart = 0.0; // première soumission depuis que la file était vide
+	int32  BatchCommitted = 0;
+};
@@ -0,0 +1,261 @@
+#include "DungeonSeedMiningCommandlet.h"
+#include "DungeonGenerator.h"
+#include "DungeonPipeline.h"
+#include "Triangulation_Based.h"
+#include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+
+void FDungeonLayoutMetrics::Compute(const FDungeonLayout& Layout, const FDungeonGenStats& Stats, const FDungeonGenParams& Params, FDungeonLayoutMetrics& Out)
+{
+	Out = FDungeonLayoutMetrics();
+	Out.Seed  = Layout.Seed;
+	Out.Rooms = Layout.Rooms.Num();
+	Out.GenMs = static_cast<float>(Stats.TotalMs);
+	Out.PeakKB = static_cast<float>(Stats.PeakBytes / 1024.0);
+	Out.RelaxIterations = Stats.RelaxIterations;
+	Out.Culled = Stats.Culled;
+
+	if (Layout.Rooms.Num() > 0)
+	{
+		FVector2D Centroid = FVector2D::ZeroVector;
+		for (const FDungeonRoomDesc& R : Layout.Rooms) Centroid += R.Center;
+		Centroid /= Layout.Rooms.Num();
+
+		double Sum = 0.0;
+		for (const FDungeonRoomDesc& R : Layout.Rooms) Sum += (R.Center - Centroid).SizeSquared();
+		Out.RoomSpread = static_cast<float>(FMath::Sqrt(Sum / Layout.Rooms.Num()));
+	}
+
+	TArray<FVector> Points;
+	FDungeonPipeline::MainRoomCenters3D(Layout, Params.FloorHeight, Points);
+	Out.MainRooms = Points.Num();
+
+	if (Points.Num() > 0)
+	{
+		FVector Centroid = FVector::ZeroVector;
+		for (const FVector& P : Points) Centroid += P;
+		Centroid /= Points.Num();
+
+		double Sum = 0.0;
+		for (const FVector& P : Points) Sum += (P - Centroid).SizeSquared();
+		Out.MainSpread = static_cast<float>(FMath::Sqrt(Sum / Points.Num()));
+	}
+
+	TArray<TArray<int32>> Adj;
+	Adj.SetNum(Points.Num());
+	for (const FDGEdge& E : Layout.MSTEdges)
+	{
+		Adj[E.A].Add(E.B);
+		Adj[E.B].Add(E.A);
+		Out.MSTLength += static_cast<float>((Points[E.A] - Points[E.B]).Size());
+	}
+
+	// Diamètre d'un arbre : BFS depuis un sommet quelconque, puis depuis le plus éloigné
+	auto Farthest = [&Adj](int32 From, int32& OutDist)
+	{
+		TArray<int32> Dist; Dist.Init(INDEX_NONE, Adj.Num());
+		TArray<int32> Queue; Queue.Add(From); Dist[From] = 0;
+		int32 Best = From;
+		for (int32 q = 0; q < Queue.Num(); ++q)
+		{
+			const int32 U = Queue[q];
+			if (Dist[U] > Dist[Best]) Best = U;
+			for (int32 V : Adj[U]) if (Dist[V] == INDEX_NONE) { Dist[V] = Dist[U] + 1; Queue.Add(V); }
+		}
+		OutDist = Dist[Best];
+		return Best;
+	};
+	if (Points.Num() > 1)
+	{
+		int32 D = 0;
+		Farthest(Farthest(0, D), Out.MSTDiameter);
+	}
+
+	Out.CorridorSegments = Layout.Corridors.Num();
+	for (const FCorridorSeg& S : Layout.Corridors)
+		Out.CorridorLength += static_cast<float>(FVector(S.B - S.A, S.ZB - S.ZA).Size());
+}
+
+UDungeonSeedMiningCommandlet::UDungeonSeedMiningCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+bool UDungeonSeedMiningCommandlet::ParseGenParams(const FString& Params, FDungeonGenParams& Out)
+{
+	const ADungeonGenerator* Template = GetDefault<ADungeonGenerator>();
+
+	FString GeneratorPath;
+	if (FParse::Value(*Params, TEXT("Generator="), GeneratorPath))
+	{
+		UClass* Class = LoadClass<ADungeonGenerator>(nullptr, *GeneratorPath);
+		if (!Class)
+		{
+			UE_LOG(LogDungeon, Error, TEXT("Could not load generator class %s"), *GeneratorPath);
+			return false;
+		}
+		Template = Class->GetDefaultObject<ADungeonGenerator>();
+	}
+
+	Out = Template->MakeGenParams();
+	FParse::Value(*Params, TEXT("RoomsNbr="), Out.RoomsNbr);
+	FParse::Value(*Params, TEXT("MainCount="), Out.MainCount);
+	FParse::Value(*Params, TEXT("SpawnRadius="), Out.SpawnRadius);
+	FParse::Value(*Params, TEXT("Floors="), Out.FloorCount);
+	Out.FloorCount = FMath::Max(1, Out.FloorCount);
+
+	FString Placement;
+	if (FParse::Value(*Params, TEXT("Placement="), Placement))
+	{
+		Out.PlacementMode = Placement.Equals(TEXT("Poisson"), ESearchCase::IgnoreCase)
+			? EDungeonPlacementMode::PoissonDisk : EDungeonPlacementMode::UniformDisk;
+	}
+	return true;
+}
+
+static void WriteUtf8(FArchive& Ar, const FString& Text)
+{
+	FTCHARToUTF8 Utf8(*Text);
+	Ar.Serialize(const_cast<ANSICHAR*>(Utf8.Get()), Utf8.Length());
+}
+
+int32 UDungeonSeedMiningCommandlet::ComparePlacement(const FDungeonGenParams& GenParams, int32 Count, int32 StartSeed)
+{
+	struct FTotals { double Relax = 0, Culled = 0, Rooms = 0, RoomSpread = 0, MainSpread = 0, MSTLength = 0, GenMs = 0; };
+	const EDungeonPlacementMode Modes[] = { EDungeonPlacementMode::UniformDisk, EDungeonPlacementMode::PoissonDisk };
+
+	for (EDungeonPlacementMode Mode : Modes)
+	{
+		FDungeonGenParams P = GenParams;
+		P.PlacementMode = Mode;
+
+		TArray<FDungeonLayoutMetrics> Metrics;
+		Metrics.SetNum(Count);
+		ParallelFor(Count, [&](int32 i)
+		{
+			FDungeonLayout Layout;
+			FDungeonGenStats Stats;
+			FDungeonPipeline::Generate(P, StartSeed + i, Layout, &Stats);
+			FDungeonLayoutMetrics::Compute(Layout, Stats, P, Metrics[i]);
+		});
+
+		FTotals T;
+		for (const FDungeonLayoutMetrics& M : Metrics)
+		{
+			T.Relax += M.RelaxIterations; T.Culled += M.Culled; T.Rooms += M.Rooms;
+			T.RoomSpread += M.RoomSpread; T.MainSpread += M.MainSpread; T.MSTLength += M.MSTLength; T.GenMs += M.GenMs;
+		}
+		const double N = FMath::Max(1, Count);
+		UE_LOG(LogDungeon, Display, TEXT("%-8s relax %.1f it, culled %.2f, rooms %.1f, room spread %.0f, main spread %.0f, MST %.0f, %.3f ms/layout"),
+			Mode == EDungeonPlacementMode::PoissonDisk ? TEXT("Poisson") : TEXT("Uniform"),
+			T.Relax / N, T.Culled / N, T.Rooms / N, T.RoomSpread / N, T.MainSpread / N, T.MSTLength / N, T.GenMs / N);
+	}
+	return 0;
+}
+
+int32 UDungeonSeedMiningCommandlet::Main(const FString& Params)
+{
+	FDungeonGenParams GenParams;
+	if (!ParseGenParams(Params, GenParams)) return 1;
+
+	int32 Count = 1000;
+	int32 StartSeed = 1;
+	int32 BatchSize = 4096;
+	FString OutPath = FPaths::ProjectSavedDir() / TEXT("DungeonSeeds.csv");
+	FParse::Value(*Params, TEXT("Count="), Count);
+	FParse::Value(*Params, TEXT("StartSeed="), StartSeed);
+	if (FParse::Param(*Params, TEXT("ComparePlacement"))) return ComparePlacement(GenParams, FMath::Max(1, Count), StartSeed);
+	FParse::Value(*Params, TEXT("Batch="), BatchSize);
+	FParse::Value(*Params, TEXT("Out="), OutPath);
+	BatchSize = FMath::Max(1, BatchSize);
+
+	int32 MinMSTDiameter = 0;
+	float MinSpread = 0.f, MinCorridorLength = 0.f, MaxCorridorLength = TNumericLimits<float>::Max();
+	FParse::Value(*Params, TEXT("MinMSTDiameter="), MinMSTDiameter);
+	FParse::Value(*Params, TEXT("MinSpread="), MinSpread);
+	FParse::Value(*Params, TEXT("MinCorridorLength="), MinCorridorLength);
+	FParse::Value(*Params, TEXT("MaxCorridorLength="), MaxCorridorLength);
+
+	const bool bJson = OutPath.EndsWith(TEXT(".json"), ESearchCase::IgnoreCase);
+
+	TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*OutPath));
+	if (!Writer)
+	{
+		UE_LOG(LogDungeon, Error, TEXT("Could not open %s for writing"), *OutPath);
+		return 1;
+	}
+
+	WriteUtf8(*Writer, bJson
+		? FString(TEXT("{\n\"layouts\": ["))
+		: FString(TEXT("Seed,Rooms,MainRooms,MSTDiameter,MSTLength,MainSpread,RoomSpread,CorridorLength,CorridorSegments,RelaxIterations,Culled,GenMs,PeakKB\n")));
+
+	const int32 Cores = FTaskGraphInterface::Get().GetNumWorkerThreads() + 1;
+	UE_LOG(LogDungeon, Display, TEXT("Mining %d dungeon seeds from %d on %d cores -> %s"), Count, StartSeed, Cores, *OutPath);
+
+	TArray<FDungeonLayoutMetrics> Batch;
+	int32 Kept = 0;
+	double CpuMs = 0.0;
+	const double T0 = FPlatformTime::Seconds();
+
+	for (int32 Base = 0; Base < Count; Base += BatchSize)
+	{
+		const int32 N = FMath::Min(BatchSize, Count - Base);
+		Batch.SetNum(N);
+
+		ParallelFor(N, [&](int32 i)
+		{
+			FDungeonLayout Layout;
+			FDungeonGenStats Stats;
+			FDungeonPipeline::Generate(GenParams, StartSeed + Base + i, Layout, &Stats);
+			FDungeonLayoutMetrics::Compute(Layout, Stats, GenParams, Batch[i]);
+		});
+
+		// Écriture au fil de l'eau, batch par batch, pour ne jamais garder tous les résultats en mémoire
+		FString Chunk;
+		for (const FDungeonLayoutMetrics& M : Batch)
+		{
+			CpuMs += M.GenMs;
+			if (M.MSTDiameter < MinMSTDiameter || M.MainSpread < MinSpread) continue;
+			if (M.CorridorLength < MinCorridorLength || M.CorridorLength > MaxCorridorLength) continue;
+
+			if (bJson)
+			{
+				Chunk += FString::Printf(
+					TEXT("%s\n  {\"seed\": %d, \"rooms\": %d, \"mainRooms\": %d, \"mstDiameter\": %d, \"mstLength\": %.1f, \"mainSpread\": %.1f, \"roomSpread\": %.1f, \"corridorLength\": %.1f, \"corridorSegments\": %d, \"relaxIterations\": %d, \"culled\": %d, \"genMs\": %.3f, \"peakKB\": %.1f}"),
+					Kept > 0 ? TEXT(",") : TEXT(""), M.Seed, M.Rooms, M.MainRooms, M.MSTDiameter, M.MSTLength,
+					M.MainSpread, M.RoomSpread, M.CorridorLength, M.CorridorSegments, M.RelaxIterations, M.Culled, M.GenMs, M.PeakKB);
+			}
+			else
+			{
+				Chunk += FString::Printf(TEXT("%d,%d,%d,%d,%.1f,%.1f,%.1f,%.1f,%d,%d,%d,%.3f,%.1f\n"),
+					M.Seed, M.Rooms, M.MainRooms, M.MSTDiameter, M.MSTLength,
+					M.MainSpread, M.RoomSpread, M.CorridorLength, M.CorridorSegments, M.RelaxIterations, M.Culled, M.GenMs, M.PeakKB);
+			}
+			++Kept;
+		}
+		WriteUtf8(*Writer, Chunk);
+
+		UE_LOG(LogDungeon, Display, TEXT("  %d / %d layouts"), Base + N, Count);
+	}
+
+	const double WallS = FPlatformTime::Seconds() - T0;
+	const double PerSecond = WallS > 0.0 ? Count / WallS : 0.0;
+	const double PerSecondPerCore = PerSecond / Cores;
+
+	if (bJson)
+	{
+		WriteUtf8(*Writer, FString::Printf(
+			TEXT("\n],\n\"summary\": {\"count\": %d, \"kept\": %d, \"cores\": %d, \"wallSeconds\": %.3f, \"layoutsPerSecond\": %.1f, \"layoutsPerSecondPerCore\": %.1f, \"avgGenMs\": %.3f}\n}\n"),
+			Count, Kept, Cores, WallS, PerSecond, PerSecondPerCore, Count > 0 ? CpuMs / Count : 0.0));
+	}
+	Writer->Close();
+
+	UE_LOG(LogDungeon, Display, TEXT("Mined %d layouts (%d kept) in %.2f s: %.1f layouts/s, %.1f layouts/s/core (avg %.3f ms/layout)"),
+		Count, Kept, WallS, PerSecond, PerSecondPerCore, Count > 0 ? CpuMs / Count : 0.0);
+	return 0;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "DungeonSeedMiningCommandlet.generated.h"
+
+struct FDungeonLayout;
+struct FDungeonGenParams;
+struct FDungeonGenStats;
+
+struct FDungeonLayoutMetrics
+{
+	int32 Seed = 0;
+	int32 Rooms = 0;
+	int32 MainRooms = 0;
+	int32 MSTDiameter = 0;     // plus long chemin du MST, en nombre d'arêtes
+	float MSTLength = 0.f;
+	float MainSpread = 0.f;    // distance RMS des main rooms à leur barycentre
+	float RoomSpread = 0.f;    // idem sur toutes les salles : compacité du placement
+	float CorridorLength = 0.f;
+	int32 CorridorSegments = 0;
+	float GenMs = 0.f;
+	float PeakKB = 0.f;        // pic mémoire du pipeline (FDungeonGenStats::PeakBytes)
+	int32 RelaxIterations = 0;
+	int32 Culled = 0;
+
+	static void Compute(const FDungeonLayout& Layout, const FDungeonGenStats& Stats, const FDungeonGenParams& Params, FDungeonLayoutMetrics& Out);
+};
+
+// Génère N layouts en parallèle sans spawner d'acteurs et écrit leurs métriques en CSV/JSON.
+// UnrealEditor-Cmd Triangulation_Based -run=DungeonSeedMining -Count=10000 -StartSeed=1 -Out=Seeds.csv
+//   [-Generator=/Game/BP_Generator.BP_Generator_C] [-RoomsNbr=] [-MainCount=] [-SpawnRadius=] [-Placement=Uniform|Poisson] [-Floors=]
+//   [-MinMSTDiameter=] [-MinSpread=] [-MinCorridorLength=] [-MaxCorridorLength=]
+// -ComparePlacement : mêmes seeds en placement uniforme puis Poisson, moyennes affichées (pas de fichier écrit)
+UCLASS()
+class TRIANGULATION_BASED_API UDungeonSeedMiningCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UDungeonSeedMiningCommandlet();
+	virtual int32 Main(const FString& Params) override;
+
+	static bool ParseGenParams(const FString& Params, FDungeonGenParams& Out);
+
+private:
+	static int32 ComparePlacement(const FDungeonGenParams& GenParams, int32 Count, int32 StartSeed);
+};
@@ -0,0 +1,290 @@
+#include "DungeonTetrahedralizer.h"
+#include "Algo/Sort.h"
+
+namespace
+{
+	struct FTet
+	{
+		int32 V[4]; // orientés positivement
+		int32 N[4]; // N[f] : voisin à travers la face opposée à V[f], INDEX_NONE sur le bord du super-tétraèdre
+	};
+
+	struct FCavityFace
+	{
+		int32 V[4];     // sommets du nouveau tétraèdre (le point inséré remplace V[Apex])
+		int32 Apex;
+		int32 Outer;    // tétraèdre hors cavité de l'autre côté de la face
+		int32 OuterSlot;
+	};
+
+	uint32 Part1By2(uint32 X)
+	{
+		X &= 0x3FF;
+		X = (X | (X << 16)) & 0x030000FF;
+		X = (X | (X << 8))  & 0x0300F00F;
+		X = (X | (X << 4))  & 0x030C30C3;
+		X = (X | (X << 2))  & 0x09249249;
+		return X;
+	}
+
+	// Perturbation déterministe minuscule : les centres sont quantifiés et les étages coplanaires,
+	// sans elle les cas cosphériques seraient la règle plutôt que l'exception
+	double Jitter(int32 Index, uint32 Axis)
+	{
+		uint32 H = (static_cast<uint32>(Index) * 2654435761u) ^ (Axis * 0x9E3779B9u);
+		H *= 0x85EBCA6Bu;
+		H ^= H >> 13;
+		return ((H & 0xFFFF) / 65535.0 - 0.5) * 1e-7;
+	}
+
+	template<typename Kernel>
+	class FBowyerWatson3D
+	{
+	public:
+		using FVec = typename Kernel::FVec;
+		using FScalar = typename Kernel::FScalar;
+
+		TArray<FVec> Pts;
+		TArray<FTet> Tets;
+
+		explicit FBowyerWatson3D(int32 NumPoints)
+		{
+			Pts.Reserve(NumPoints + 4);
+			Tets.Reserve(NumPoints * 7);
+			Mark.Reserve(NumPoints * 7);
+		}
+
+		void Init(int32 NumReal)
+		{
+			// Super-tétraèdre "coin" contenant largement le cube [-1, 1]^3
+			const FScalar M = 50, C = 150;
+			Pts.Add(FVec(-M, -M, -M));
+			Pts.Add(FVec(C + 2 * M, -M, -M));
+			Pts.Add(FVec(-M, C + 2 * M, -M));
+			Pts.Add(FVec(-M, -M, C + 2 * M));
+
+			FTet& T = Tets.AddDefaulted_GetRef();
+			T.V[0] = NumReal; T.V[1] = NumReal + 1; T.V[2] = NumReal + 2; T.V[3] = NumReal + 3;
+			for (int32& N : T.N) N = INDEX_NONE;
+			Mark.Add(0);
+		}
+
+		bool IsAlive(int32 t) const { return Tets[t].V[0] != INDEX_NONE; }
+
+		void Insert(int32 Idx)
+		{
+			const FVec& P = Pts[Idx];
+			const int32 Start = Locate(P);
+
+			// Cavité : tétraèdres dont la sphère circonscrite contient P, connexes au tétraèdre de départ
+			++Epoch;
+			Cavity.Reset();
+			Stack.Reset();
+			Cavity.Add(Start); Stack.Add(Start); Mark[Start] = Epoch;
+			while (Stack.Num() > 0)
+			{
+				const int32 t = Stack.Pop(EAllowShrinking::No);
+				for (int32 f = 0; f < 4; ++f)
+				{
+					const int32 n = Tets[t].N[f];
+					if (n == INDEX_NONE || Mark[n] == Epoch) continue;
+					const FTet& Tn = Tets[n];
+					if (Kernel::InSphere(Pts[Tn.V[0]], Pts[Tn.V[1]], Pts[Tn.V[2]], Pts[Tn.V[3]], P) > 0)
+					{
+						Mark[n] = Epoch;
+						Cavity.Add(n);
+						Stack.Add(n);
+					}
+				}
+			}
+
+			// Bord de la cavité ; si une face n'est pas visible depuis P (erreur d'arrondi), la cavité s'étend au voisin
+			bool bStarShaped = false;
+			while (!bStarShaped)
+			{
+				bStarShaped = true;
+				Boundary.Reset();
+				for (int32 c = 0; c < Cavity.Num() && bStarShaped; ++c)
+				{
+					const int32 t = Cavity[c];
+					for (int32 f = 0; f < 4; ++f)
+					{
+						const int32 n = Tets[t].N[f];
+						if (n != INDEX_NONE && Mark[n] == Epoch) continue;
+
+						if (OrientWith(t, f, P) <= 0 && n != INDEX_NONE)
+						{
+							Mark[n] = Epoch;
+							Cavity.Add(n);
+							bStarShaped = false;
+							break;
+						}
+
+						FCavityFace& B = Boundary.AddDefaulted_GetRef();
+						FMemory::Memcpy(B.V, Tets[t].V, sizeof(B.V));
+						B.V[f] = Idx;
+						B.Apex = f;
+						B.Outer = n;
+						B.OuterSlot = INDEX_NONE;
+						if (n != INDEX_NONE)
+							for (int32 k = 0; k < 4; ++k) if (Tets[n].N[k] == t) B.OuterSlot = k;
+					}
+				}
+			}
+
+			for (int32 t : Cavity)
+			{
+				Tets[t].V[0] = INDEX_NONE;
+				Free.Add(t);
+			}
+
+			// Un nouveau tétraèdre par face du bord ; les faces internes se recollent par leur arête opposée à P
+			Link.Reset();
+			for (const FCavityFace& B : Boundary)
+			{
+				int32 nt;
+				if (Free.Num() > 0) nt = Free.Pop(EAllowShrinking::No);
+				else { nt = Tets.AddUninitialized(); Mark.Add(0); }
+
+				FTet& T = Tets[nt];
+				FMemory::Memcpy(T.V, B.V, sizeof(T.V));
+				for (int32& N : T.N) N = INDEX_NONE;
+				T.N[B.Apex] = B.Outer;
+				if (B.Outer != INDEX_NONE) Tets[B.Outer].N[B.OuterSlot] = nt;
+
+				for (int32 j = 0; j < 4; ++j)
+				{
+					if (j == B.Apex) continue;
+					int32 E[2], m = 0;
+					for (int32 k = 0; k < 4; ++k) if (k != j && k != B.Apex) E[m++] = B.V[k];
+					const uint64 Key = (static_cast<uint64>(FMath::Min(E[0], E[1])) << 32) | static_cast<uint32>(FMath::Max(E[0], E[1]));
+
+					if (const int32* Other = Link.Find(Key))
+					{
+						Tets[*Other >> 2].N[*Other & 3] = nt;
+						T.N[j] = *Other >> 2;
+						Link.Remove(Key);
+					}
+					else
+					{
+						Link.Add(Key, nt * 4 + j);
+					}
+				}
+				Last = nt;
+			}
+		}
+
+	private:
+		TArray<int32> Mark;
+		TArray<int32> Free;
+		TArray<int32> Cavity;
+		TArray<int32> Stack;
+		TArray<FCavityFace> Boundary;
+		TMap<uint64, int32> Link;
+		int32 Epoch = 0;
+		int32 Last = 0;
+
+		// Orientation du tétraèdre t dont le sommet f est remplacé par P : > 0 si P est du même côté de la face que V[f]
+		int32 OrientWith(int32 t, int32 f, const FVec& P) const
+		{
+			const FTet& T = Tets[t];
+			const FVec* V[4] = { &Pts[T.V[0]], &Pts[T.V[1]], &Pts[T.V[2]], &Pts[T.V[3]] };
+			V[f] = &P;
+			return Kernel::Orient(*V[0], *V[1], *V[2], *V[3]);
+		}
+
+		// Marche de visibilité depuis le dernier tétraèdre créé ; avec l'ordre de Morton elle ne fait que quelques pas
+		int32 Locate(const FVec& P) const
+		{
+			int32 t = Last;
+			const int32 MaxSteps = Tets.Num() + 16;
+			for (int32 Step = 0; Step < MaxSteps; ++Step)
+			{
+				bool bMoved = false;
+				for (int32 k = 0; k < 4; ++k)
+				{
+					const int32 f = (k + Step) & 3; // face de départ tournante : évite de boucler sur un cas dégénéré
+					if (OrientWith(t, f, P) < 0 && Tets[t].N[f] != INDEX_NONE)
+					{
+						t = Tets[t].N[f];
+						bMoved = true;
+						break;
+					}
+				}
+				if (!bMoved) return t;
+			}
+
+			// Filet de sécurité : recherche exhaustive
+			for (int32 i = 0; i < Tets.Num(); ++i)
+			{
+				if (!IsAlive(i)) continue;
+				if (OrientWith(i, 0, P) >= 0 && OrientWith(i, 1, P) >= 0 &&
+				    OrientWith(i, 2, P) >= 0 && OrientWith(i, 3, P) >= 0) return i;
+			}
+			return t;
+		}
+	};
+}
+
+template<typename Kernel>
+void FDungeonTetrahedralizer::Build(const TArray<FVector>& Points, TArray<FDGTetra>& OutTets, TSet<FDGEdge>& OutEdges)
+{
+	using FVec = typename Kernel::FVec;
+
+	OutTets.Reset();
+	OutEdges.Reset();
+	const int32 N = Points.Num();
+	if (N < 2) return;
+
+	// Normalisation dans [-1, 1]^3 : les prédicats en double gardent leur précision quelle que soit la taille du donjon
+	FBox BB(Points[0], Points[0]);
+	for (const FVector& P : Points) BB += P;
+	const FVector Mid = BB.GetCenter();
+	const double Scale = FMath::Max(BB.GetExtent().GetMax(), 1e-3);
+
+	FBowyerWatson3D<Kernel> BW(N);
+	for (int32 i = 0; i < N; ++i)
+	{
+		BW.Pts.Add(FVec((Points[i] - Mid) / Scale + FVector(Jitter(i, 1), Jitter(i, 2), Jitter(i, 3))));
+	}
+	BW.Init(N);
+
+	TArray<uint32> Codes;
+	Codes.SetNumUninitialized(N);
+	for (int32 i = 0; i < N; ++i)
+	{
+		auto Q = [](double V) { return static_cast<uint32>(FMath::Clamp((V + 1.0) * 0.5 * 1023.0, 0.0, 1023.0)); };
+		const FVec& P = BW.Pts[i];
+		Codes[i] = Part1By2(Q(P.X)) | (Part1By2(Q(P.Y)) << 1) | (Part1By2(Q(P.Z)) << 2);
+	}
+
+	TArray<int32> Order;
+	Order.SetNumUninitialized(N);
+	for (int32 i = 0; i < N; ++i) Order[i] = i;
+	Algo::StableSort(Order, [&Codes](int32 A, int32 B) { return Codes[A] < Codes[B]; });
+
+	for (int32 Idx : Order) BW.Insert(Idx);
+
+	for (int32 t = 0; t < BW.Tets.Num(); ++t)
+	{
+		if (!BW.IsAlive(t)) continue;
+		const int32* V = BW.Tets[t].V;
+
+		for (int32 a = 0; a < 4; ++a)
+			for (int32 b = a + 1; b < 4; ++b)
+				if (V[a] < N && V[b] < N) OutEdges.Add(FDGEdge(V[a], V[b]));
+
+		if (V[0] < N && V[1] < N && V[2] < N && V[3] < N)
+			OutTets.Emplace(V[0], V[1], V[2], V[3]);
+	}
+}
+
+template void FDungeonTetrahedralizer::Build<TDungeonKernel<float,  3, FDungeonFastPredicates>>(const TArray<FVector>&, TArray<FDGTetra>&, TSet<FDGEdge>&);
+template void FDungeonTetrahedralizer::Build<TDungeonKernel<double, 3, FDungeonFastPredicates>>(const TArray<FVector>&, TArray<FDGTetra>&, TSet<FDGEdge>&);
+template void FDungeonTetrahedralizer::Build<TDungeonKernel<float,  3, FDungeonExactPredicates>>(const TArray<FVector>&, TArray<FDGTetra>&, TSet<FDGEdge>&);
+template void FDungeonTetrahedralizer::Build<TDungeonKernel<double, 3, FDungeonExactPredicates>>(const TArray<FVector>&, TArray<FDGTetra>&, TSet<FDGEdge>&);
+
+void FDungeonTetrahedralizer::Build(const TArray<FVector>& Points, TArray<FDGTetra>& OutTets, TSet<FDGEdge>& OutEdges)
+{
+	Build<FDungeonKernel3D>(Points, OutTets, OutEdges);
+}
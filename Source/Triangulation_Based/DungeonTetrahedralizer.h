@@ -0,0 +1,19 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DungeonTypes.h"
+#include "DungeonGeometryKernel.h"
+
+// Tétraédrisation de Delaunay 3D (Bowyer–Watson) des centres de main rooms répartis sur plusieurs étages.
+// Points insérés dans l'ordre de Morton, tétraèdres reliés par adjacence et localisés par marche :
+// chaque insertion ne parcourt que quelques tétraèdres puis sa cavité, au lieu de tester tout le maillage.
+struct TRIANGULATION_BASED_API FDungeonTetrahedralizer
+{
+	// OutTets : tétraèdres n'utilisant aucun sommet du super-tétraèdre
+	// OutEdges : toutes les arêtes entre deux vrais points (y compris celles des tétraèdres du bord)
+	static void Build(const TArray<FVector>& Points, TArray<FDGTetra>& OutTets, TSet<FDGEdge>& OutEdges);
+
+	// Même chose avec un noyau explicite (instancié pour les quatre noyaux 3D), utilisé par le benchmark
+	template<typename Kernel>
+	static void Build(const TArray<FVector>& Points, TArray<FDGTetra>& OutTets, TSet<FDGEdge>& OutEdges);
+};
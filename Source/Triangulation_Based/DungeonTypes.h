@@ -0,0 +1,93 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DungeonTypes.generated.h"
+
+UENUM(BlueprintType)
+enum class EDungeonPlacementMode : uint8
+{
+	UniformDisk, // points uniformes dans le disque, séparés ensuite par la relaxation
+	PoissonDisk  // dart throwing à la Bridson tenant compte de la taille des salles : presque aucun chevauchement initial
+};
+
+struct FDGEdge
+{
+	int32 A = INDEX_NONE;
+	int32 B = INDEX_NONE;
+
+	FDGEdge() = default;
+	FDGEdge(int32 InA, int32 InB)
+	{
+		A = FMath::Min(InA, InB);
+		B = FMath::Max(InA, InB);
+	}
+	bool operator==(const FDGEdge& Other) const { return A == Other.A && B == Other.B; }
+	friend uint32 GetTypeHash(const FDGEdge& E) { return HashCombine(::GetTypeHash(E.A), ::GetTypeHash(E.B)); }
+};
+
+struct FDGTriangle
+{
+	int32 I = INDEX_NONE, J = INDEX_NONE, K = INDEX_NONE;
+	FDGTriangle() = default;
+	FDGTriangle(int32 InI, int32 InJ, int32 InK) : I(InI), J(InJ), K(InK) {}
+};
+
+struct FDGTetra
+{
+	int32 I = INDEX_NONE, J = INDEX_NONE, K = INDEX_NONE, L = INDEX_NONE;
+	FDGTetra() = default;
+	FDGTetra(int32 InI, int32 InJ, int32 InK, int32 InL) : I(InI), J(InJ), K(InK), L(InL) {}
+};
+
+struct FCorridorSeg
+{
+	FVector2D A, B;
+	float ZA = 0.f, ZB = 0.f; // hauteur des extrémités : ZA != ZB pour une rampe/un escalier entre deux étages
+	FCorridorSeg() {};
+	FCorridorSeg(const FVector2D& InA, const FVector2D& InB) : A(InA), B(InB) {};
+	FCorridorSeg(const FVector2D& InA, const FVector2D& InB, float InZA, float InZB) : A(InA), B(InB), ZA(InZA), ZB(InZB) {};
+	bool IsRamp() const { return ZA != ZB; }
+};
+
+// Salle décrite sans acteur, centre relatif au centre du donjon
+struct FDungeonRoomDesc
+{
+	FVector2D Center = FVector2D::ZeroVector;
+	FVector2D Size   = FVector2D::ZeroVector;
+	int32 Floor = 0;
+	bool bIsMain = false;
+};
+
+// Règle de placement d'un prop, sans UObject (convertie depuis UDungeonPropSet)
+struct FDungeonPropRule
+{
+	int32 Entry = INDEX_NONE;        // index de l'entrée dans le UDungeonPropSet (choix du mesh)
+	float Weight = 1.f;
+	float Radius = 50.f;             // emprise au sol, sert à espacer les props
+	FVector2D ScaleRange = FVector2D(1.f, 1.f);
+	bool bSnapYawTo90 = false;
+	bool bMainRoomsOnly = false;
+};
+
+struct FDungeonPropRules
+{
+	TArray<FDungeonPropRule> Rules;
+	float DensityPerSquareMeter = 0.f;
+	int32 MaxPerRoom = 0;
+	float WallMargin = 40.f;
+	float CorridorClearance = 200.f; // rayon libre autour des entrées de couloir et de leur trajet dans la salle
+	int32 MaxAttemptsPerProp = 8;
+
+	bool IsEnabled() const { return Rules.Num() > 0 && DensityPerSquareMeter > 0.f && MaxPerRoom > 0; }
+};
+
+// Prop placé, position relative au centre du donjon comme les salles
+struct FDungeonProp
+{
+	FVector2D Position = FVector2D::ZeroVector;
+	float Yaw = 0.f;
+	float Scale = 1.f;
+	int32 Floor = 0;
+	int32 Rule = INDEX_NONE;
+};
+
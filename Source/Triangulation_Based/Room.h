@@ -20,6 +20,8 @@ public:
 	float Thickness = 2000.f;
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Room")
 	bool bIsMain = false;
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Room")
+	int32 Floor = 0;
 
 protected:
 	virtual void OnConstruction(const FTransform& Transform) override;
@@ -0,0 +1,124 @@
+#include "Misc/AutomationTest.h"
+#include "DungeonLayout.h"
+#include "DungeonPipeline.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+// Rejoue côté "client" ce que fait ADungeonGenerator::RebuildFromReplicatedLayout, sans monde ni acteurs :
+// génération serveur, Pack, Unpack, couloirs et props recalculés, puis comparaison élément par élément.
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDungeonLayoutReplicationTest, "Dungeon.Layout.ClientRebuildMatchesServer",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+namespace
+{
+	FDungeonGenParams MakeTestParams()
+	{
+		FDungeonGenParams P;
+		P.RoomsNbr = 120;
+		P.SpawnRadius = 4000.f;
+		P.MainCount = 14;
+
+		P.Props.DensityPerSquareMeter = 0.3f;
+		P.Props.MaxPerRoom = 16;
+		for (int32 i = 0; i < 3; ++i)
+		{
+			FDungeonPropRule& R = P.Props.Rules.AddDefaulted_GetRef();
+			R.Entry = i;
+			R.Weight = 1.f + i;
+			R.Radius = 30.f + 20.f * i;
+			R.ScaleRange = FVector2D(0.8f, 1.2f);
+			R.bSnapYawTo90 = (i == 1);
+			R.bMainRoomsOnly = (i == 2);
+		}
+		return P;
+	}
+}
+
+bool FDungeonLayoutReplicationTest::RunTest(const FString& Parameters)
+{
+	struct FCase { const TCHAR* Name; int32 Floors; bool bStraight; int32 Clusters; };
+	const FCase Cases[] =
+	{
+		{ TEXT("flat"),         1, false, 0 },
+		{ TEXT("straight"),     1, true,  0 },
+		{ TEXT("floors"),       3, false, 0 },
+		{ TEXT("hierarchical"), 1, false, 4 },
+	};
+
+	for (const FCase& Case : Cases)
+	{
+		FDungeonGenParams P = MakeTestParams();
+		P.FloorCount = Case.Floors;
+		P.bCorridorFollowMSTExact = Case.bStraight;
+		P.ClusterCount = Case.Clusters;
+
+		for (int32 Seed = 1; Seed <= 3; ++Seed)
+		{
+			const FString Ctx = FString::Printf(TEXT("%s, seed %d"), Case.Name, Seed);
+
+			FDungeonLayout Server;
+			FDungeonPipeline::Generate(P, Seed, Server);
+			TestTrue(*FString::Printf(TEXT("%s: server has corridors"), *Ctx), Server.Corridors.Num() > 0);
+			TestTrue(*FString::Printf(TEXT("%s: server has props"), *Ctx), Server.Props.Num() > 0);
+
+			TArray<uint8> Packed;
+			Server.Pack(Packed);
+
+			FDungeonLayout Client;
+			if (!TestTrue(*FString::Printf(TEXT("%s: unpack"), *Ctx), Client.Unpack(Packed))) continue;
+			Client.Seed = Seed;
+			FDungeonPipeline::BuildCorridors(P, Client);
+			FDungeonPipeline::PopulateRooms(P, Client);
+
+			TestEqual(*FString::Printf(TEXT("%s: rooms"), *Ctx), Client.Rooms.Num(), Server.Rooms.Num());
+			for (int32 i = 0; i < FMath::Min(Client.Rooms.Num(), Server.Rooms.Num()); ++i)
+			{
+				const FDungeonRoomDesc& C = Client.Rooms[i];
+				const FDungeonRoomDesc& S = Server.Rooms[i];
+				if (C.Center != S.Center || C.Size != S.Size || C.Floor != S.Floor || C.bIsMain != S.bIsMain)
+				{
+					AddError(FString::Printf(TEXT("%s: room %d differs"), *Ctx, i));
+					break;
+				}
+			}
+
+			TestTrue(*FString::Printf(TEXT("%s: MST edges"), *Ctx), Client.MSTEdges == Server.MSTEdges);
+
+			TestEqual(*FString::Printf(TEXT("%s: corridor segments"), *Ctx), Client.Corridors.Num(), Server.Corridors.Num());
+			for (int32 i = 0; i < FMath::Min(Client.Corridors.Num(), Server.Corridors.Num()); ++i)
+			{
+				const FCorridorSeg& C = Client.Corridors[i];
+				const FCorridorSeg& S = Server.Corridors[i];
+				if (C.A != S.A || C.B != S.B || C.ZA != S.ZA || C.ZB != S.ZB)
+				{
+					AddError(FString::Printf(TEXT("%s: corridor segment %d differs"), *Ctx, i));
+					break;
+				}
+			}
+
+			TestEqual(*FString::Printf(TEXT("%s: props"), *Ctx), Client.Props.Num(), Server.Props.Num());
+			for (int32 i = 0; i < FMath::Min(Client.Props.Num(), Server.Props.Num()); ++i)
+			{
+				const FDungeonProp& C = Client.Props[i];
+				const FDungeonProp& S = Server.Props[i];
+				if (C.Position != S.Position || C.Yaw != S.Yaw || C.Scale != S.Scale || C.Floor != S.Floor || C.Rule != S.Rule)
+				{
+					AddError(FString::Printf(TEXT("%s: prop %d differs"), *Ctx, i));
+					break;
+				}
+			}
+
+			TestTrue(*FString::Printf(TEXT("%s: corridors/props crc"), *Ctx), Client.ComputeDerivedCrc() == Server.ComputeDerivedCrc());
+		}
+	}
+
+	// L'empreinte doit voir un prop déplacé
+	FDungeonLayout Layout;
+	FDungeonPipeline::Generate(MakeTestParams(), 7, Layout);
+	const uint32 Before = Layout.ComputeDerivedCrc();
+	if (Layout.Props.Num() > 0) Layout.Props[0].Position.X += 10.0;
+	TestTrue(TEXT("crc detects a moved prop"), Layout.ComputeDerivedCrc() != Before);
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
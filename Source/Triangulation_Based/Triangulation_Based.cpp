@@ -4,3 +4,9 @@
 #include "Modules/ModuleManager.h"
 
 IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, Triangulation_Based, "Triangulation_Based" );
+
+DEFINE_LOG_CATEGORY(LogDungeon);
+
+LLM_DEFINE_TAG(Dungeon);
+LLM_DEFINE_TAG(Dungeon_Generation);
+LLM_DEFINE_TAG(Dungeon_Rooms);
@@ -3,4 +3,11 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "HAL/LowLevelMemTracker.h"
 
+DECLARE_LOG_CATEGORY_EXTERN(LogDungeon, Log, All);
+
+// Tags LLM (-llm) : Dungeon/Generation pour les données du pipeline, Dungeon/Rooms pour les salles spawnées
+LLM_DECLARE_TAG_API(Dungeon, TRIANGULATION_BASED_API);
+LLM_DECLARE_TAG_API(Dungeon_Generation, TRIANGULATION_BASED_API);
+LLM_DECLARE_TAG_API(Dungeon_Rooms, TRIANGULATION_BASED_API);